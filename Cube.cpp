@@ -14,35 +14,305 @@
 
 #include "Cube.h"
 
+#ifdef CUBE_GAMMA
+#include "gamma.h"
+#endif
+
 static volatile bool suspended = false;
+static volatile bool swapPending = false;
+static bool doubleBuffered = false;
+
+// The frame the pollers (animation, fades, scrolling, spectrum) draw on
+// together, see cubeFrameFree()
+static bool frameDrawn = false;                 // Since the last show()
+static bool frameShown = false;                 // Not copied back since
+
+// Timer1 settings for a refresh period, see Cube::setRefreshPeriod()
+
+typedef struct {
+  unsigned int top;              // ICR1
+  byte         clockSelectBits;  // TCCR1B CS12:CS10
+}
+  timer1_t;
+
+static long refreshPeriod = TIMER1_PERIOD;      // microseconds
+
+static timer1_t timer1Period;                   // Normal refresh period
+static timer1_t timer1AutoPeriod;               // While the sketch is busy
+static volatile bool timer1Auto    = false;
+static volatile bool timer1Pending = false;     // Apply at next Timer1 BOTTOM
+static bool timer1Slow = false;
+
+static volatile byte pollCount = 0;             // Incremented by cubePoll()
+static byte pollCountFrame = 0;
 
 byte currentColor  = COLOR_PLANE_RED;
 byte currentPlaneZ = 0;
 
-rgb_t led[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];  // [x][y][z].color[]
+#ifdef NO_DOUBLE_BUFFER
+static const byte LED_BUFFERS = 1;
+#else
+static const byte LED_BUFFERS = 2;
+#endif
+
+frame_t ledBuffer[LED_BUFFERS];  // See frame.h for the layout
+
+#ifdef CUBE_LAYERS
+frame_t *volatile led        = & layerBuffer[0];
+#else
+frame_t *volatile led        = & ledBuffer[0];
+#endif
+frame_t *volatile ledDisplay = & ledBuffer[0];
+
+// Per buffer Z plane flags, one bit per color plane, marking the slices that
+// may differ from the buffer's ledWire[].  Drawing code only ever stores
+// LED_DIRTY_PLANE, the refresh interrupt (display buffer) or cubeSerialize()
+// (back buffer) clears them.
+
+volatile byte ledDirty[LED_BUFFERS][CUBE_SIZE];
+
+#ifdef CUBE_LAYERS
+volatile byte *volatile ledDrawDirty    = layerDirty[0];
+#else
+volatile byte *volatile ledDrawDirty    = ledDirty[0];
+#endif
+volatile byte *volatile ledDisplayDirty = ledDirty[0];
+
+// The buffer that show() swaps with the display buffer (or the display buffer
+// itself).  That is the drawing buffer, unless drawing goes into the layers,
+// which are then composed into it (see layer.cpp).
+
+#ifdef CUBE_LAYERS
+frame_t *volatile ledBack = & ledBuffer[0];
+volatile byte *volatile ledBackDirty = ledDirty[0];
+#else
+static frame_t *volatile &ledBack = led;
+static volatile byte *volatile &ledBackDirty = ledDrawDirty;
+#endif
+
+// Each buffer serialized in MY9262 wire order, [buffer][Z][color][word].  The
+// back buffer by cubeSerialize() (show() or poll()), so that a swap leaves
+// the refresh interrupt only streaming it, the display buffer by the refresh
+// interrupt, when drawn on without double buffering.  Without CUBE_GAMMA only the high byte
+// of each 16 bit grayscale word is stored, the low byte is 0x00.
+// CUBE_LAYOUT_PLANAR frames are already in wire order, so then only
+// CUBE_GAMMA needs ledWire[].
+
+#ifdef CUBE_GAMMA
+typedef unsigned int wire_t;
+#else
+typedef byte wire_t;
+#endif
+
+#if defined(CUBE_GAMMA)  ||  ! defined(CUBE_LAYOUT_PLANAR)
+#define LED_WIRE
+
+typedef wire_t wire_frame_t[CUBE_SIZE][COLOR_PLANES][PLANE_VOXELS];
+
+wire_frame_t ledWire[LED_BUFFERS];
+static wire_frame_t *volatile ledWireDisplay = & ledWire[0];
+#endif
 
 void loadColorPlaneZ(byte color, byte planeZ);
 
-//long cubeLastTime = 0;
-//long cubeTimer1Period = 0;
+#ifdef CUBE_SPI_INTERRUPT
+#if CUBE_EDGE > 8
+#error "CUBE_SPI_INTERRUPT counts the bytes of a color plane in a byte, so only up to CUBE_EDGE 8"
+#endif
 
-ISR(TIMER1_OVF_vect) {                            // 116 microseconds
-//digitalWrite(7, digitalRead(7) ^ 1);            // Diagnosis via oscilloscope
-  if(suspended)
-    return;
+static const byte SPI_IDLE = 0xff;
+
+static wire_t        *spiWire;
+static byte           spiColor;
+static byte           spiPlaneZ;
+static bool           spiSpeSet;
+static volatile byte  spiIndex = SPI_IDLE;        // Byte being sent
+
+void startColorPlaneZ(byte color, byte planeZ);
+#endif
+
+static inline void swapBuffers(void) {            // Interrupts must be disabled
+  frame_t *buffer = ledDisplay;
+  ledDisplay  = ledBack;
+  ledBack     = buffer;
+
+  volatile byte *dirty = ledDisplayDirty;
+  ledDisplayDirty = ledBackDirty;
+  ledBackDirty    = dirty;
+
+#ifdef LED_WIRE
+  ledWireDisplay = & ledWire[ledDisplay - ledBuffer];
+#endif
+
+  swapPending = false;
+}
+
+#ifdef LED_WIRE
+static inline void serializeColorPlaneZ(
+  byte buffer,
+  byte color,
+  byte planeZ) {
+
+  frame_t *frame = & ledBuffer[buffer];
+  wire_t  *wire  = ledWire[buffer][planeZ][color];
+
+#if defined(CUBE_GAMMA)
+  const unsigned int *gamma = GAMMA_MAP(color);
+#endif
+
+#if defined(CUBE_LAYOUT_PLANAR)
+  byte *voxel = (*frame)[planeZ][color];
+
+  for (byte w = 0;  w < PLANE_VOXELS;  w ++) {
+    wire[w] = pgm_read_word(gamma + voxel[w]);
+  }
+#elif defined(CUBE_GAMMA)
+  for (byte w = 0;  w < PLANE_VOXELS;  w ++) {
+    wire[w] = pgm_read_word(gamma + frameGetColor(frame, w % CUBE_SIZE, w / CUBE_SIZE, planeZ, color));
+  }
+#else
+  for (byte w = 0;  w < PLANE_VOXELS;  w ++) {
+    wire[w] = frameGetColor(frame, w % CUBE_SIZE, w / CUBE_SIZE, planeZ, color);
+  }
+#endif
+}
+#endif
+
+// Re-serializes the changed slices of the back buffer when double buffering,
+// so that show() leaves the refresh interrupt nothing to do.  The displayed
+// buffer is only drawn on without double buffering, and its slices are then
+// re-serialized by the refresh interrupt, see wireColorPlaneZ().
+
+static void cubeSerialize(void) {
+#ifdef LED_WIRE
+  if (! doubleBuffered  ||  swapPending) return;  // Back buffer not ours
 
+  byte buffer = ledBack - ledBuffer;
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    byte dirty = ledDirty[buffer][z];
+    if (dirty == 0) continue;
+
+    ledDirty[buffer][z] = 0;
+    for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+      if (dirty & (1 << color)) serializeColorPlaneZ(buffer, color, z);
+    }
+  }
+#endif
+}
+
+// Returns the slice of the display buffer to load into the LED drivers, in
+// wire order, re-serializing it first if it has been drawn on since
+
+static inline wire_t *wireColorPlaneZ(            // Interrupts must be disabled
+  byte color,
+  byte planeZ) {
+
+#ifdef LED_WIRE
+  byte colorBit = 1 << color;
+
+  if (ledDisplayDirty[planeZ] & colorBit) {
+    ledDisplayDirty[planeZ] &= ~colorBit;
+    serializeColorPlaneZ(ledDisplay - ledBuffer, color, planeZ);
+  }
+
+  return((*ledWireDisplay)[planeZ][color]);
+#else
+  return((*ledDisplay)[planeZ][color]);
+#endif
+}
+
+#ifdef CUBE_STATS
+cube_stats_t cubeStats;
+
+static inline unsigned int statsTicks(void) {     // Timer1 ticks since BOTTOM
+  unsigned int ticks = TCNT1;                     // Phase correct, counts down after TOP
+  return((TIFR1 & _BV(ICF1))  ?  2 * ICR1 - ticks  :  ticks);
+}
+#endif
+
+static inline void applyTimer1(void) {            // Only at Timer1 BOTTOM
+  timer1_t *timer1 = (timer1Auto  &&  timer1Slow)  ?  & timer1AutoPeriod  :  & timer1Period;
+
+  ICR1   = timer1->top;
+  TCCR1B = (TCCR1B & ~(_BV(CS10) | _BV(CS11) | _BV(CS12))) | timer1->clockSelectBits;
+  timer1Pending = false;
+}
+
+static inline void nextColorPlaneZ(void) {
   if (++ currentColor > COLOR_PLANE_BLUE) {
     currentColor  = COLOR_PLANE_RED;
     currentPlaneZ = (currentPlaneZ + 1) % CUBE_SIZE;
+
+    if (currentPlaneZ == 0  &&  swapPending) swapBuffers();  // See Cube::show()
+
+    if (currentPlaneZ == 0  &&  timer1Auto) {     // Slow down while loop() is busy
+      bool busy = (pollCount == pollCountFrame);
+      pollCountFrame = pollCount;
+
+      if (busy != timer1Slow) {
+        timer1Slow = busy;
+        applyTimer1();
+      }
+    }
+
+#ifdef CUBE_STATS
+    if (currentPlaneZ == 0) cubeStats.frames ++;
+#endif
   }
+}
+
+ISR(TIMER1_OVF_vect) {                            // 116 microseconds
+//digitalWrite(7, digitalRead(7) ^ 1);            // Diagnosis via oscilloscope
+  if (timer1Pending) applyTimer1();
 
+  if(suspended)
+    return;
+
+#ifdef CUBE_STATS
+  TIFR1 = _BV(ICF1);                              // Clear TOP flag, see statsTicks()
+  unsigned int ticksStart = statsTicks();
+#endif
+
+#ifdef CUBE_SPI_INTERRUPT
+  if (spiIndex == SPI_IDLE) {
+    nextColorPlaneZ();
+    startColorPlaneZ(currentColor, currentPlaneZ);
+  }
+#ifdef CUBE_STATS
+  else {
+    cubeStats.overruns ++;                        // Previous plane still loading
+  }
+#endif
+#else
+  nextColorPlaneZ();
   loadColorPlaneZ(currentColor, currentPlaneZ);
+#endif
 
-//long thisTime    = micros();
-//cubeTimer1Period = thisTime - cubeLastTime;
-//cubeLastTime     = thisTime;
+#ifdef CUBE_STATS
+  unsigned int ticksScan = statsTicks();
+#endif
 
   serialHandler();
+
+#ifdef CUBE_STATS
+  unsigned int ticksEnd = statsTicks();
+  unsigned int ticks    = ticksEnd - ticksStart;
+
+  if (ticks < cubeStats.isrMin) cubeStats.isrMin = ticks;
+  if (ticks > cubeStats.isrMax) cubeStats.isrMax = ticks;
+  cubeStats.isrTotal += ticks;
+  cubeStats.isrCount ++;
+
+  ticks = ticksScan - ticksStart;
+  if (ticks > cubeStats.scanMax) cubeStats.scanMax = ticks;
+
+  ticks = ticksEnd - ticksScan;
+  if (ticks > cubeStats.serialMax) cubeStats.serialMax = ticks;
+  cubeStats.serialTotal += ticks;
+
+  if (TIFR1 & _BV(TOV1)) cubeStats.overruns ++;   // Next period has already started
+#endif
 }
 
 Cube::Cube() {
@@ -84,16 +354,27 @@ void Cube::begin(
   my9262WriteCommand(0x0ff0);  // Highest current
 //my9262WriteCommand(0x0800);  // Lowest current
 
+#ifdef CUBE_PALETTE
+  cubePaletteReset();
+#endif
+
   all(BLACK);
+  cubeDirtyAllBuffers();
 
-  initializeTimer1(TIMER1_PERIOD);
-}
+#ifdef CUBE_LAYERS
+  cubeLayersReset();
+#endif
 
-void Cube::initializeTimer1(
-  long period) {  // microseconds
+  initializeTimer1(refreshPeriod);
 
-  TCCR1A = 0;
-  TCCR1B = _BV(WGM13);
+#ifdef CUBE_STATS
+  cubeStatsReset();
+#endif
+}
+
+static void timer1Settings(
+  long      period,       // microseconds
+  timer1_t *timer1) {
 
   unsigned char clockSelectBits;
   long cycles = (F_CPU / 2000000) * period;
@@ -105,14 +386,66 @@ void Cube::initializeTimer1(
   else if((cycles >>= 2) < RESOLUTION) clockSelectBits = _BV(CS12) | _BV(CS10);
   else        cycles = RESOLUTION - 1, clockSelectBits = _BV(CS12) | _BV(CS10);
 
+  timer1->top             = cycles;
+  timer1->clockSelectBits = clockSelectBits;
+}
+
+void Cube::initializeTimer1(
+  long period) {  // microseconds
+
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM13);
+
+  timer1Settings(period, & timer1Period);
+
   char oldSREG = SREG;
   cli();
-  ICR1 = cycles;
+  ICR1 = timer1Period.top;
   SREG = oldSREG;
 
   TIMSK1 = _BV(TOIE1);
   TCCR1B &= ~(_BV(CS10) | _BV(CS11) | _BV(CS12));
-  TCCR1B |= clockSelectBits;
+  TCCR1B |= timer1Period.clockSelectBits;
+}
+
+void Cube::setRefreshPeriod(
+  long period,
+  long autoPeriod) {
+
+  cubeSetRefreshPeriod(period, autoPeriod);
+}
+
+/* The new Timer1 settings are applied by the refresh interrupt, when the
+ * counter is at BOTTOM, so the current period always completes normally.
+ */
+void cubeSetRefreshPeriod(
+  long period,            // microseconds
+  long autoPeriod) {
+
+  period = constrain(period, REFRESH_PERIOD_MIN, REFRESH_PERIOD_MAX);
+  if (autoPeriod > 0) {
+    autoPeriod = constrain(autoPeriod, period, REFRESH_PERIOD_MAX);
+  }
+
+  timer1_t timer1;
+  timer1_t timer1Busy;
+  timer1Settings(period, & timer1);
+  timer1Settings(autoPeriod, & timer1Busy);
+
+  char oldSREG = SREG;
+  cli();
+  refreshPeriod    = period;
+  timer1Period     = timer1;
+  timer1AutoPeriod = timer1Busy;
+  timer1Auto       = (autoPeriod > 0);
+  timer1Slow       = false;
+  timer1Pending    = true;
+  SREG = oldSREG;
+}
+
+long Cube::getRefreshPeriod()
+{
+  return refreshPeriod;
 }
 
 void Cube::my9262WriteCommand(
@@ -120,40 +453,55 @@ void Cube::my9262WriteCommand(
 
   digitalWrite(PIN_LED_LAT, LOW);
 
-  for (byte b = 0;  b < 16;  b ++) {
-    digitalWrite(MOSI, (command & 0x8000) == 0x8000);              // MSB first
-    command <<= 1;
+  for (byte chip = 0;  chip < MY9262_CHAIN;  chip ++) {  // The same for each MY9262
+    unsigned int value = command;
 
-    if (b == 6) digitalWrite(PIN_LED_LAT, HIGH);  // MY9262 Write Command latch
-    digitalWrite(SCK, HIGH);
-    digitalWrite(SCK, LOW);
+    for (byte b = 0;  b < 16;  b ++) {
+      digitalWrite(MOSI, (value & 0x8000) == 0x8000);              // MSB first
+      value <<= 1;
+                           // MY9262 Write Command latch
+      if (chip == MY9262_CHAIN - 1  &&  b == 6) digitalWrite(PIN_LED_LAT, HIGH);
+      digitalWrite(SCK, HIGH);
+      digitalWrite(SCK, LOW);
+    }
   }
 
   digitalWrite(PIN_LED_LAT, LOW);
 }
 
-void loadColorPlaneZ(
-  byte color,
-  byte planeZ) {
+// Bit-bang the last word, latch all of the words into the MY9262 outputs and
+// select the plane with the 74154.  SPI must have finished the other words.
 
-  bool spe_set = (SPCR & (1 << SPE)); // Record the current SPI enable state
+static inline void latchColorPlaneZ(
+  wire_t *wire,
+  byte    color,
+  byte    planeZ) {
 
-  SPCR  = ((1 << SPE) | (1 << MSTR));  // TODO: Set MSTR in initializeTimer1()
-  SPSR |= (1 << SPI2X);                // TODO: Move to initializeTimer1()
+  SPCR &= ~(1 << SPE);     // SPI.end(), disable SPI so we can bit-bang MOSI
 
-  for (byte w = 0;  w < 15;  w ++) {
-    SPI.transfer(led[w % CUBE_SIZE][w >> 2][planeZ].color[color]);
-    SPI.transfer(0x00);
-                           // MY9262 Data latch
-    PORTD |=  (1 << 6);    // digitalWrite(PIN_LED_LAT, HIGH);
+#ifdef CUBE_GAMMA
+  unsigned int value = wire[PLANE_VOXELS - 1];
+
+  for (byte b = 0;  b < 16;  b ++) {  // MSB first
+    if (b == 14) {         // MY9262 Global latch
+      PORTD |=  (1 << 6);  // digitalWrite(PIN_LED_LAT, HIGH);
+    }
+
+    if (value & 0x8000) {  // digitalWrite(MOSI, (value & 0x8000) == 0x8000);
+      PORTB |=  (1 << 2);
+    }
+    else {
+      PORTB &= ~(1 << 2);
+    }
+
+    value <<= 1;
     PORTB |=  (1 << 1);    // digitalWrite(SCK, HIGH);
     PORTB &= ~(1 << 1);    // digitalWrite(SCK, LOW);
-    PORTD &= ~(1 << 6);    // digitalWrite(PIN_LED_LAT, LOW);
   }
 
-  SPCR &= ~(1 << SPE);     // SPI.end(), disable SPI so we can bit-bang MOSI
-
-  byte value = led[3][3][planeZ].color[color];
+  PORTB &= ~(1 << 2);      // digitalWrite(MOSI, LOW);
+#else
+  byte value = wire[PLANE_VOXELS - 1];
 
   for (byte b = 0;  b < 8;  b ++) {  // LSB first
     if (value & 0x80) {    // digitalWrite(MOSI, (value & 0x80) == 0x80);
@@ -178,24 +526,198 @@ void loadColorPlaneZ(
     PORTB |=  (1 << 1);    // digitalWrite(SCK, HIGH);
     PORTB &= ~(1 << 1);    // digitalWrite(SCK, LOW);
   }
+#endif
 
                            // Disable 7154, MY9262 latch complete
   PORTE |=  (1 << 6);      // digitalWrite(PIN_LED_EN, HIGH);
   PORTD &= ~(1 << 6);      // digitalWrite(PIN_LED_LAT, LOW);
 
-  byte colorPlaneZSelect = color + (planeZ * 3);
+  byte colorPlaneZSelect = color + (planeZ * COLOR_PLANES);
 
+#ifdef CUBE_PLANE_SELECT
+  CUBE_PLANE_SELECT(colorPlaneZSelect);
+#else
   PORTB &= B00001111;      // Assume these pins are all in consecutive order
   PORTB |= (colorPlaneZSelect << 4);
+#endif
 
 // Enable 74154
   PORTE &= ~(1 << 6);      // digitalWrite(PIN_LED_EN, LOW);
+}
+
+void loadColorPlaneZ(
+  byte color,
+  byte planeZ) {
+
+  bool spe_set = (SPCR & (1 << SPE)); // Record the current SPI enable state
+
+  SPCR  = ((1 << SPE) | (1 << MSTR));  // TODO: Set MSTR in initializeTimer1()
+  SPSR |= (1 << SPI2X);                // TODO: Move to initializeTimer1()
+
+  wire_t *wire = wireColorPlaneZ(color, planeZ);
+
+  for (byte w = 0;  w < PLANE_VOXELS - 1;  w ++) {
+#ifdef CUBE_GAMMA
+    SPI.transfer(wire[w] >> 8);
+    SPI.transfer(wire[w] & 0xff);
+#else
+    SPI.transfer(wire[w]);
+    SPI.transfer(0x00);
+#endif
+    if ((w + 1) % MY9262_CHAIN) continue;  // A word for each MY9262 in the chain
+                           // MY9262 Data latch
+    PORTD |=  (1 << 6);    // digitalWrite(PIN_LED_LAT, HIGH);
+    PORTB |=  (1 << 1);    // digitalWrite(SCK, HIGH);
+    PORTB &= ~(1 << 1);    // digitalWrite(SCK, LOW);
+    PORTD &= ~(1 << 6);    // digitalWrite(PIN_LED_LAT, LOW);
+  }
+
+  latchColorPlaneZ(wire, color, planeZ);
 
   // Re-enable SPI hardware if it was enabled
   if(spe_set)
     SPCR |= (1 << SPE);
 }
 
+#ifdef CUBE_SPI_INTERRUPT
+/* Interrupt driven version of loadColorPlaneZ().  The refresh interrupt sends
+ * the first byte, then each SPI transfer complete interrupt data latches the
+ * previous word (when due) and sends the next byte.  After the last but one
+ * word latchColorPlaneZ() finishes off, with SPI disabled.
+ */
+
+static inline byte spiWireByte(
+  byte index) {
+
+#ifdef CUBE_GAMMA
+  return((index & 1)  ?  spiWire[index >> 1] & 0xff  :  spiWire[index >> 1] >> 8);
+#else
+  return((index & 1)  ?  0x00  :  spiWire[index >> 1]);
+#endif
+}
+
+void startColorPlaneZ(
+  byte color,
+  byte planeZ) {
+
+  spiSpeSet = (SPCR & (1 << SPE)); // Record the current SPI enable state
+  spiWire   = wireColorPlaneZ(color, planeZ);
+  spiColor  = color;
+  spiPlaneZ = planeZ;
+  spiIndex  = 0;
+
+  SPCR  = ((1 << SPIE) | (1 << SPE) | (1 << MSTR));
+  SPSR |= (1 << SPI2X);
+  SPDR  = spiWireByte(0);
+}
+
+ISR(SPI_STC_vect) {
+  byte index = spiIndex + 1;
+
+  if (index & 1) {
+    SPDR = spiWireByte(index);     // Second byte of the word
+    spiIndex = index;
+    return;
+  }
+  if ((index >> 1) % MY9262_CHAIN == 0) {
+                           // MY9262 Data latch
+    PORTD |=  (1 << 6);    // digitalWrite(PIN_LED_LAT, HIGH);
+    PORTB |=  (1 << 1);    // digitalWrite(SCK, HIGH);
+    PORTB &= ~(1 << 1);    // digitalWrite(SCK, LOW);
+    PORTD &= ~(1 << 6);    // digitalWrite(PIN_LED_LAT, LOW);
+  }
+
+  if (index < 2 * (PLANE_VOXELS - 1)) {  // First byte of the next word
+    SPDR = spiWireByte(index);
+    spiIndex = index;
+    return;
+  }
+
+  SPCR &= ~(1 << SPIE);
+  latchColorPlaneZ(spiWire, spiColor, spiPlaneZ);
+
+  // Re-enable SPI hardware if it was enabled
+  if(spiSpeSet)
+    SPCR |= (1 << SPE);
+
+  spiIndex = SPI_IDLE;
+}
+#endif
+
+void Cube::poll()
+{
+  cubePoll();
+}
+
+static void copyDisplayDirty(                     // Back buffer now matches display
+  volatile byte *dirty) {
+
+  char oldSREG = SREG;
+  cli();
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) dirty[z] = ledDisplayDirty[z];
+  ledBackDirty = dirty;
+  SREG = oldSREG;
+
+#ifdef LED_WIRE                                   // Not changed until the next swap
+  memcpy(& ledWire[(dirty - ledDirty[0]) / CUBE_SIZE], ledWireDisplay, sizeof(wire_frame_t));
+#endif
+}
+
+// The pollers only draw on the back buffer while cubeFrameFree(), and call
+// cubeFrameDrawn() when they have.  When double buffering, whatever they drew
+// in a cubePoll() is shown once, at the end, and once that frame has been
+// displayed it is copied back once, for them to draw the next one on.
+
+boolean cubeFrameFree(void) {
+  return(! doubleBuffered  ||  ! (frameShown  ||  swapPending));
+}
+
+void cubeFrameDrawn(void) {
+  frameDrawn = true;
+}
+
+static void framePoll(void) {
+  if (! doubleBuffered) {
+    frameDrawn = false;
+  }
+  else if (frameDrawn) {
+    cubeShow();
+  }
+  else if (frameShown  &&  ! swapPending) {
+    memcpy(ledBack, ledDisplay, sizeof(frame_t));
+    copyDisplayDirty(ledBackDirty);
+    frameShown = false;
+  }
+}
+
+void cubePoll(void) {
+  pollCount ++;
+
+#ifdef CUBE_STATS
+  cubeStats.loops ++;
+#endif
+
+  serialPoll();
+  cubeAnimationPoll();
+  cubeFadePoll();
+  cubeScrollPoll();
+#ifdef CUBE_SPECTRUM
+  cubeSpectrumPoll();
+#endif
+  framePoll();
+
+#ifdef CUBE_LAYERS
+  if (! doubleBuffered) cubeCompose();           // Otherwise by Cube::show()
+#endif
+  cubeSerialize();
+}
+
+#ifndef NO_CUBE_YIELD
+void yield(void) {                                // Called by delay()
+  cubePoll();
+}
+#endif
+
 void Cube::suspend()
 {
   suspended = true;
@@ -205,3 +727,132 @@ void Cube::resume()
 {
   suspended = false;
 }
+
+// Every slice of every buffer must be re-serialized, e.g. when the colors
+// they were serialized from change (see palette.cpp)
+
+void cubeDirtyAllBuffers(void) {
+  memset((void *) ledDirty, LED_DIRTY_PLANE, sizeof(ledDirty));
+}
+
+void Cube::doubleBuffer(
+  boolean enable) {
+
+  if (LED_BUFFERS < 2  ||  enable == doubleBuffered) return;
+
+  if (enable) {
+    byte buffer = (ledDisplay == & ledBuffer[0])  ?  LED_BUFFERS - 1  :  0;
+
+    memcpy(& ledBuffer[buffer], ledDisplay, sizeof(frame_t));
+    copyDisplayDirty(ledDirty[buffer]);
+    ledBack = & ledBuffer[buffer];
+  }
+  else {
+    show();
+    waitForShow();
+    ledBack = ledDisplay;
+    ledBackDirty = ledDisplayDirty;
+  }
+
+  doubleBuffered = enable;
+  frameDrawn = false;
+  frameShown = false;
+}
+
+void Cube::show()
+{
+  cubeShow();
+}
+
+void cubeShow(void) {
+#ifdef CUBE_LAYERS
+  cubeCompose();
+#endif
+  cubeSerialize();
+
+  if (doubleBuffered) {
+    swapPending = true;
+    frameShown  = frameShown  ||  frameDrawn;
+    frameDrawn  = false;
+  }
+}
+
+boolean Cube::isShowPending()
+{
+  return swapPending;
+}
+
+void Cube::waitForShow()
+{
+  if (! doubleBuffered) return;
+
+  if (suspended) {                 // No refresh interrupt to do the swap for us
+    char oldSREG = SREG;
+    cli();
+    if (swapPending) swapBuffers();
+    SREG = oldSREG;
+  }
+
+  while (swapPending) ;
+
+  memcpy(ledBack, ledDisplay, sizeof(frame_t));
+  copyDisplayDirty(ledBackDirty);
+  frameShown = false;
+}
+
+#ifdef CUBE_STATS
+void Cube::resetStats()
+{
+  cubeStatsReset();
+}
+
+void cubeStatsReset(void) {
+  char oldSREG = SREG;
+  cli();
+  memset(& cubeStats, 0, sizeof(cubeStats));
+  cubeStats.isrMin = 0xffff;
+  cubeStats.since  = millis();
+  SREG = oldSREG;
+}
+
+void Cube::printStats()
+{
+  cubeStatsPrint();
+}
+
+void cubeStatsPrint(void) {
+  if (! serial) return;
+
+  char oldSREG = SREG;
+  cli();
+  cube_stats_t stats = cubeStats;
+  SREG = oldSREG;
+
+  unsigned long elapsed = millis() - stats.since;
+  if (elapsed == 0) elapsed = 1;
+  if (stats.isrCount == 0) stats.isrCount = 1;
+
+  serial->print(F("isr ticks min/avg/max: "));
+  serial->print(stats.isrMin);
+  serial->print('/');
+  serial->print(stats.isrTotal / stats.isrCount);
+  serial->print('/');
+  serial->println(stats.isrMax);
+  serial->print(F("isr ticks budget: "));
+  serial->println(2 * ICR1);
+  serial->print(F("scan ticks max: "));
+  serial->println(stats.scanMax);
+  serial->print(F("serial ticks avg/max: "));
+  serial->print(stats.serialTotal / stats.isrCount);
+  serial->print('/');
+  serial->println(stats.serialMax);
+  serial->print(F("command us max: "));
+  serial->println(stats.commandMax);
+  serial->print(F("overruns: "));
+  serial->println(stats.overruns);
+  serial->print(F("frames/s: "));
+  serial->println(stats.frames * 1000 / elapsed);
+  serial->print(F("loops/s: "));
+  serial->println(stats.loops * 1000 / elapsed);
+}
+#endif
@@ -24,14 +24,103 @@
 //  - the commands. The link to the website is preserved.
 //#define NO_SERIAL_HELP_TEXT
 
+// Uncomment the following to remove double buffering support (see Cube::show())
+//  - This saves 384 bytes of SRAM (192 with CUBE_LAYOUT_PLANAR, without CUBE_GAMMA).
+//  - Cube::show() still compiles, but does nothing.
+//#define NO_DOUBLE_BUFFER
+
+// Uncomment the following if the sketch, or another library, provides its own yield()
+//  - Serial commands are then only executed when the sketch calls Cube::poll().
+//#define NO_CUBE_YIELD
+
+// Uncomment the following to measure the LED refresh interrupt and main loop timing
+//  - Adds the 'stats;' and 'resetstats;' commands, and Cube::printStats().  The
+//  - measurements cost a few microseconds per refresh interrupt.
+//#define CUBE_STATS
+
+// Uncomment the following to send gamma corrected 16 bit grayscale values to the LEDs
+//  - Gives smooth, even looking fades down to very low brightness.  Costs 512 bytes
+//  - of program storage space and 192 bytes of SRAM per buffer.  Also uncomment CUBE_GAMMA_PER_CHANNEL
+//  - to use separate red, green and blue curves (1.5K of program storage space).
+//#define CUBE_GAMMA
+//#define CUBE_GAMMA_PER_CHANNEL
+
+// Uncomment the following to store the LED colors by Z plane and color plane (see frame.h)
+//  - Loading the LED drivers and whole Z plane operations then work on contiguous memory,
+//  - and without CUBE_GAMMA it saves 192 bytes of SRAM per buffer.
+//#define CUBE_LAYOUT_PLANAR
+
+// Uncomment the following to load the LED drivers using the SPI transfer complete interrupt
+//  - The refresh interrupt then returns within a few microseconds, so other interrupts
+//  - (e.g. serial) aren't held up.  The sketch must not use SPI for anything else.
+//#define CUBE_SPI_INTERRUPT
+
+// Uncomment the following to draw into CUBE_LAYERS compositing layers (see Cube::layer())
+//  - Each layer is blended over the layers below it, once per frame, for only the Z
+//  - planes that have changed.  Each layer costs 192 bytes of SRAM (on a 4x4x4 cube).
+//#define CUBE_LAYERS 2
+
+// Uncomment the following to store a palette index for each LED, instead of its color (see Cube::palette())
+//  - Colors drawn become the nearest of the CUBE_PALETTE (2 to 256) palette colors, and changing
+//  - a palette color changes every LED drawn in it.  A frame then takes 32 bytes of SRAM for up
+//  - to 16 colors, or 64 bytes, instead of 192 (on a 4x4x4 cube).  Not with CUBE_LAYERS or
+//  - CUBE_LAYOUT_PLANAR.
+//#define CUBE_PALETTE 16
+
+// Uncomment the following for a pool of CUBE_PARTICLES (1 to 255) particles (see Cube::particleStep())
+//  - Each particle costs 17 bytes of SRAM, plus 33 bytes for each of the PARTICLE_EMITTERS
+//  - emitters.  Stepping costs the same for each live particle, and uses no heap.
+//#define CUBE_PARTICLES 24
+
+// Uncomment the following for a sound reactive spectrum of SPECTRUM_BANDS bars (see Cube::spectrum())
+//  - While running, the ADC samples an analog input (e.g. a microphone module) continuously,
+//  - which costs about 3% of the CPU, and analogRead() can't be used.  Costs 230 bytes of SRAM.
+//#define CUBE_SPECTRUM
+
+// Uncomment the following to build for a larger cube, with CUBE_EDGE LEDs along each edge
+//  - Each Z plane is then driven by a chain of CUBE_EDGE * CUBE_EDGE / 16 MY9262s, so
+//  - CUBE_EDGE must be a multiple of 4 (up to 12).  A 74154 only selects 16 color planes,
+//  - so define CUBE_PLANE_SELECT(select) to output the color plane (0 to CUBE_EDGE * 3 - 1)
+//  - for cubes larger than 5.  An 8x8x8 frame is 1536 bytes, so on a Leonardo also
+//  - uncomment NO_DOUBLE_BUFFER and CUBE_LAYOUT_PLANAR.
+//#define CUBE_EDGE 8
+//#define CUBE_PLANE_SELECT(select) ...
+
+#ifndef CUBE_EDGE
+#define CUBE_EDGE 4
+#endif
+
+#if CUBE_EDGE % 4 != 0  ||  CUBE_EDGE > 12
+#error "CUBE_EDGE must be 4, 8 or 12"
+#endif
+
+#if CUBE_EDGE * 3 > 16  &&  ! defined(CUBE_PLANE_SELECT)
+#error "Cubes larger than 5 need CUBE_PLANE_SELECT(select) defined"
+#endif
+
+#if defined(CUBE_PALETTE)  &&  (CUBE_PALETTE < 2  ||  CUBE_PALETTE > 256)
+#error "CUBE_PALETTE must be 2 to 256"
+#endif
+
+#if defined(CUBE_PALETTE)  &&  (defined(CUBE_LAYERS)  ||  defined(CUBE_LAYOUT_PLANAR))
+#error "CUBE_PALETTE can't be used with CUBE_LAYERS or CUBE_LAYOUT_PLANAR"
+#endif
+
+#if defined(CUBE_PARTICLES)  &&  (CUBE_PARTICLES < 1  ||  CUBE_PARTICLES > 255)
+#error "CUBE_PARTICLES must be 1 to 255"
+#endif
+
 #include "color.h"
 #include "engine.h"
 
 #define RESOLUTION 65536
 
-static const byte CUBE_SIZE = 4;
+static const byte CUBE_SIZE = CUBE_EDGE;
 static const long TIMER1_PERIOD = 500;  // microseconds = 2 Khz per plane
 
+static const long REFRESH_PERIOD_MIN =   250;  // microseconds, see Cube::setRefreshPeriod()
+static const long REFRESH_PERIOD_MAX = 10000;
+
 // Analog pins ...
 
 static const byte PIN_ACCELERATION_X = 0;
@@ -52,6 +141,9 @@ static const byte PIN_LED_A3 = 11;
 
 static const byte PIN_LED_LAT = 12;  // Enable is HIGH
 
+static const byte MY9262_CHANNELS = 16;
+static const byte MY9262_CHAIN    = CUBE_SIZE * CUBE_SIZE / MY9262_CHANNELS;  // Per Z plane
+
 static const byte COLOR_PLANE_RED   = 0;
 static const byte COLOR_PLANE_GREEN = 1;
 static const byte COLOR_PLANE_BLUE  = 2;
@@ -62,6 +154,40 @@ static const byte X = 0;
 static const byte Y = 1;
 static const byte Z = 2;
 
+#include "frame.h"
+#include "sprite.h"
+#include "animation.h"
+#include "particle.h"
+#include "font.h"
+#include "spectrum.h"
+
+// Layer blend modes, see Cube::layerBlend()
+
+static const byte LAYER_REPLACE  = 0;  // Covers the layers below
+static const byte LAYER_ADD      = 1;  // Adds to the layers below, saturating
+static const byte LAYER_MULTIPLY = 2;  // Scales the layers below (e.g. masks)
+static const byte LAYER_MAX      = 3;  // The brighter of this and the layers below
+static const byte LAYER_ALPHA    = 4;  // Lit (not BLACK) voxels cover the layers below
+
+// Timing measurements, see CUBE_STATS.  Timer1 ticks are CPU cycles at the
+// default TIMER1_PERIOD, and a refresh period is 2 * ICR1 ticks long.
+
+typedef struct {
+  unsigned int  isrMin;       // Refresh interrupt duration, Timer1 ticks
+  unsigned int  isrMax;
+  unsigned long isrTotal;
+  unsigned long isrCount;
+  unsigned int  scanMax;      // ... of which loading the LED drivers
+  unsigned int  serialMax;    // ... of which buffering serial input
+  unsigned long serialTotal;
+  unsigned int  overruns;     // Interrupts that ran into the next period
+  unsigned long commandMax;   // Serial command execution, microseconds
+  unsigned long frames;       // Complete refreshes of all Z planes
+  unsigned long loops;        // Calls to Cube::poll()
+  unsigned long since;        // millis() when last reset
+}
+  cube_stats_t;
+
 class Cube {
   private:
     rgb_t currentColor;
@@ -75,19 +201,93 @@ class Cube {
     void begin(byte serialPort = -1, long baudRate = 115200);
     boolean hasReceivedSerialCommand();
 
+    /* Execute received serial commands. Called automatically by delay(),
+       sketches whose loop() doesn't call delay() must call poll() instead.
+       The refresh interrupt only buffers incoming characters, so serial
+       traffic can't disturb the LED refresh timing.
+     */
+    void poll();
+
+#ifdef CUBE_STATS
+    void printStats();
+    void resetStats();
+#endif
+
 	void setDelegate(void (*fp)(int, rgb_t));
 	boolean inUserMode();
     void all(rgb_t rgb);
     void set(byte x, byte y, byte z, rgb_t rgb);
     void next(rgb_t rgb);
-    void line(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb);
+    void line(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb, byte thickness = 1);
+    void triangle(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, byte x3, byte y3, byte z3, rgb_t rgb);
+    void quad(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, byte x3, byte y3, byte z3, byte x4, byte y4, byte z4, rgb_t rgb);
     void box(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb, byte style = 0, rgb_t fill = BLACK);
     void sphere(byte x1, byte y1, byte z1, byte size, rgb_t rgb, rgb_t fill = BLACK);
+    void ellipsoid(byte x1, byte y1, byte z1, byte sizeX, byte sizeY, byte sizeZ, rgb_t rgb, byte style = 0, rgb_t fill = BLACK);
     void shift(byte axis, byte direction);
     void copyplane(byte axis, byte position, byte destination);
     void moveplane(byte axis, byte position, byte destination, rgb_t rgb);
     void setplane(byte axis, byte position, rgb_t rgb);
 
+    /* Whole cube transforms: rotate() turns the cube by quarter turns (1 to
+       3) about an axis, anticlockwise looking from its positive end, mirror()
+       reverses one axis and transpose() swaps two axes.
+     */
+    void rotate(byte axis, byte quarters = 1);
+    void mirror(byte axis);
+    void transpose(byte axis1, byte axis2);
+
+    /* Voxel sprites (see sprite.h), drawn with their first voxel at X, Y,
+       Z, which may be outside the cube.  Voxels in the key colour are not
+       drawn.  spriteColor() draws all of the other voxels in one colour,
+       spriteCollision() returns true when two sprites have voxels, other
+       than the key colour, in the same place.
+     */
+    void sprite(const byte *sprite, int x, int y, int z, rgb_t key = BLACK);
+    void spriteColor(const byte *sprite, int x, int y, int z, rgb_t rgb, rgb_t key = BLACK);
+    boolean spriteCollision(
+      const byte *sprite1, int x1, int y1, int z1,
+      const byte *sprite2, int x2, int y2, int z2, rgb_t key = BLACK);
+
+    /* Animations (see animation.h), played from program memory by poll()
+       (or delay()), so the sketch carries on meanwhile.  play() shows the
+       first frame straight away, then each frame after the one before's
+       duration, loops times (0 is forever).  It returns false, and plays
+       nothing, for an animation made for another size of cube.  stop()
+       leaves the current frame displayed.
+     */
+    boolean play(const byte *animation, byte loops = 0);
+    void stop();
+    boolean isPlaying();
+
+    /* Fades, run by poll() (or delay()), so the sketch carries on
+       meanwhile.  fade() crossfades the box from X1, Y1, Z1 to X2, Y2, Z2
+       (or the whole cube) from one colour to another over period
+       milliseconds.  A fade of the same region replaces the one running,
+       and up to FADE_SLOTS fades run at the same time.  fadeStop() leaves
+       them as they are.
+     */
+    void fade(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t colorFrom, rgb_t colorTo, unsigned int period);
+    void fade(rgb_t colorFrom, rgb_t colorTo, unsigned int period);
+    boolean isFading();
+    void fadeStop();
+
+    /* Text (see font.h), one column of voxels per font column, from the
+       bottom plane up.  text() fills a face, or with FACE_WRAP all four,
+       with the background, then draws the text starting at column (which
+       may be off the face), returning its width, as textWidth() does.
+       scroll() scrolls text in from the right, one column every period
+       milliseconds, loops times (0 is forever), run by poll() (or delay()).
+       Only the face scrolls, the rest of the cube is left as it is.  font()
+       changes the font, font4x4 by default.
+     */
+    void font(const byte *font);
+    int text(const char *text, byte face, int column, rgb_t rgb, rgb_t background = BLACK);
+    int textWidth(const char *text);
+    void scroll(const char *text, byte face, rgb_t rgb, unsigned int period, rgb_t background = BLACK, byte loops = 0);
+    void scrollStop();
+    boolean isScrolling();
+
     /* Suspend and resume Cube LED output updates
        (note that suspending LED updates for any significant
        amount of time will result in cube flickering/uneven LED
@@ -95,26 +295,159 @@ class Cube {
      */
     void suspend();
     void resume();
+
+    /* Change how long each color plane is displayed for (microseconds,
+       default TIMER1_PERIOD). Longer periods leave more CPU time for the
+       sketch, but the cube flickers more.  If autoPeriod is given, the
+       cube switches to that (longer) period whenever the sketch hasn't
+       called poll() (or delay()) for a whole refresh, i.e. while it is busy
+       rendering, and back again once it does.
+     */
+    void setRefreshPeriod(long period, long autoPeriod = 0);
+    long getRefreshPeriod();
+
+    /* Double buffering: when enabled all drawing goes into a back buffer,
+       which only becomes visible when show() is called. The refresh
+       interrupt swaps the buffers at the start of the next frame (plane Z0),
+       so complex frames never tear and LED updates never need suspending.
+       waitForShow() blocks until the swap has happened, then copies the
+       displayed frame into the back buffer, ready for the next frame.
+       While an animation, fade, scroll or the spectrum runs, poll() shows
+       their frames and copies each back once displayed, which replaces
+       anything else drawn into the back buffer meanwhile.  So don't draw
+       while isPlaying(), isFading() or isScrolling(), and call
+       waitForShow() after they finish, before drawing again.
+     */
+    void doubleBuffer(boolean enable);
+    void show();
+    boolean isShowPending();
+    void waitForShow();
+
+#ifdef CUBE_LAYERS
+    /* Compositing layers: all drawing goes into the selected layer (0 to
+       CUBE_LAYERS - 1, default 0).  The layers are composed into the frame
+       that is displayed, bottom (0) to top, each blended with its mode
+       (LAYER_REPLACE ... LAYER_ALPHA) at its opacity (0 to 255).  Layer 0
+       defaults to LAYER_REPLACE, the others to LAYER_ALPHA, all at 255.
+       Composing is done by poll() (or delay()), or by show() when double
+       buffering, and only for Z planes that have been drawn on since.
+     */
+    void layer(byte index);
+    void layerBlend(byte index, byte mode, byte opacity = 255);
+    void compose();
+#endif
+
+#ifdef CUBE_PALETTE
+    /* Palette colors (0 to CUBE_PALETTE - 1).  Each LED holds a palette
+       index, colors drawn are stored as the nearest palette color (the
+       lowest numbered, if several are as near), so draw with paletteColor()
+       to use a particular entry.  Changing a palette color changes all of
+       the LEDs drawn in it at once, and paletteRotate() moves the colors of
+       entries first to last one entry up ('+') or down ('-'), wrapping
+       around, for color cycling.
+     */
+    void palette(byte index, rgb_t rgb);
+    rgb_t paletteColor(byte index);
+    void paletteRotate(byte first, byte last, byte direction = '+');
+#endif
+
+#ifdef CUBE_PARTICLES
+    /* Particles (see particle.h): particleStep(), called once per frame,
+       starts new particles from the emitters (0 to PARTICLE_EMITTERS - 1),
+       redraws the whole frame, adding each particle's colour to its voxel,
+       then moves each particle on by its velocity (after adding gravity).
+       What was drawn before is cleared, or with particleTrail(), scaled by
+       keep / 256, leaving trails.  particleBurst() starts count particles
+       from an emitter at once, e.g. for explosions.
+     */
+    void particleEmitter(byte index, const particle_emitter_t *emitter);
+    void particleBurst(byte index, byte count);
+    void particleGravity(int x, int y, int z);
+    void particleTrail(byte keep);
+    void particleStep();
+    byte particleCount();
+    void particleClear();
+#endif
+
+#ifdef CUBE_SPECTRUM
+    /* Audio spectrum (see spectrum.h): spectrum() starts sampling an analog
+       input, and from then on poll() (or delay()) draws a bar for each of
+       the SPECTRUM_BANDS frequency bands, lowest at the front left, in rgb
+       with the top voxel in peak.  spectrumLevel() is a band's level, for
+       sketches drawing their own.  spectrumStop() leaves the bars drawn.
+     */
+    void spectrum(byte pin, rgb_t rgb = GREEN, rgb_t peak = RED);
+    void spectrumStop();
+    byte spectrumLevel(byte band);
+#endif
 };
 
-//extern long cubeTimer1Period;
+extern frame_t *volatile led;         // Drawing buffer, see frame.h
+extern frame_t *volatile ledDisplay;  // Buffer being scanned
+
+/* Changed Z planes of the drawing buffer, so that only those are
+   re-serialized for the LED drivers, by the refresh interrupt, or by poll()
+   or show() when double buffering (see ledWire[] in Cube.cpp). Code that
+   writes to led directly must set ledDrawDirty[z] = LED_DIRTY_PLANE for each
+   Z plane changed.
+ */
+static const byte LED_DIRTY_PLANE = 0x07;  // Red, green and blue color planes
 
-extern rgb_t led[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+extern volatile byte *volatile ledDrawDirty;
 
 extern Stream *serial;
 
+#ifdef CUBE_LAYERS
+extern frame_t layerBuffer[CUBE_LAYERS];
+extern volatile byte layerDirty[CUBE_LAYERS][CUBE_SIZE];
+
+extern frame_t *volatile ledBack;     // The layers are composed into this
+extern volatile byte *volatile ledBackDirty;
+
+extern void cubeLayer(byte index);
+extern void cubeLayerBlend(byte index, byte mode, byte opacity = 255);
+extern void cubeLayersReset(void);
+extern void cubeCompose(void);
+#endif
+
+#ifdef CUBE_PALETTE
+extern void cubePalette(byte index, rgb_t rgb);
+extern rgb_t cubePaletteColor(byte index);
+extern void cubePaletteRotate(byte first, byte last, byte direction = '+');
+extern void cubePaletteReset(void);
+#endif
+
 extern void cubeAll(rgb_t rgb);
 extern void cubeFillPlaneZ(byte z, rgb_t rgb);
 extern void cubeSet( byte x, byte y, byte z, rgb_t rgb);
 extern void cubeNext(rgb_t rgb);
-extern void cubeLine(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb);
+extern void cubeLine(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb, byte thickness = 1);
+extern void cubeTriangle(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, byte x3, byte y3, byte z3, rgb_t rgb);
+extern void cubeQuad(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, byte x3, byte y3, byte z3, byte x4, byte y4, byte z4, rgb_t rgb);
 extern void cubeBox(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb, byte style = 0, rgb_t fill = BLACK);
 extern void cubeSphere(byte x1, byte y1, byte z1, byte size, rgb_t rgb, rgb_t fill = BLACK);
+extern void cubeEllipsoid(byte x1, byte y1, byte z1, byte sizeX, byte sizeY, byte sizeZ, rgb_t rgb, byte style = 0, rgb_t fill = BLACK);
 extern void cubeShift(byte axis, byte direction);
 extern void cubeCopyplane(byte axis, byte position, byte destination);
 extern void cubeMoveplane(byte axis, byte position, byte destination, rgb_t rgb_t);
 extern void cubeSetplane(byte axis, byte position, rgb_t rgb);
+extern void cubeRotate(byte axis, byte quarters = 1);
+extern void cubeMirror(byte axis);
+extern void cubeTranspose(byte axis1, byte axis2);
 extern byte parser(char *message, byte messageLength, bytecode_t *bytecode);
 extern void serialHandler(void);
+extern void serialPoll(void);
+extern void cubePoll(void);
+extern void cubeSetRefreshPeriod(long period, long autoPeriod = 0);
+extern void cubeDirtyAllBuffers(void);
+extern void cubeShow(void);
+extern boolean cubeFrameFree(void);
+extern void cubeFrameDrawn(void);
+
+#ifdef CUBE_STATS
+extern cube_stats_t cubeStats;
+extern void cubeStatsPrint(void);
+extern void cubeStatsReset(void);
+#endif
 
 #endif
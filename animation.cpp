@@ -0,0 +1,156 @@
+/*
+ * File:    animation.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Animation player, see animation.h for the format.
+ *
+ * cubeAnimationPoll(), called by cubePoll(), decodes each frame straight
+ * from program memory into the drawing buffer once it is due, so playing
+ * never blocks the sketch.  When double buffering, each frame is shown, and
+ * the next one is only decoded once it has been displayed (see
+ * cubeFrameFree() in Cube.cpp).
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+static const byte    *animationStart;             // Header
+static const byte    *animationNext;              // Next frame to decode
+static unsigned int   animationFrames;
+static unsigned int   animationFrame;             // Index of animationNext
+static unsigned long  animationDue;               // millis() for animationNext
+static byte           animationLoops;             // Still to play, 0 is forever
+static bool           animationPlaying = false;
+
+static inline unsigned int animationWord(
+  const byte *data) {
+
+  return(pgm_read_byte(data) | (pgm_read_byte(data + 1) << 8));
+}
+
+// Decodes the frame at animationNext into led, returns its duration
+
+static unsigned int animationDecode(void) {
+  const byte *data = animationNext;
+  unsigned int duration = animationWord(data);
+  data += 2;
+
+  if (duration & ANIMATION_KEYFRAME) cubeAll(BLACK);
+
+  byte x = 0, y = 0, z = 0;
+  unsigned int voxels = CUBE_SIZE * PLANE_VOXELS;
+
+  while (voxels > 0) {
+    byte code = pgm_read_byte(data ++);
+    byte type = (code & ANIMATION_RUN)  ?  code & ANIMATION_LITERAL  :  ANIMATION_SKIP;
+    byte count = (type == ANIMATION_SKIP)  ?  code + 1  :  (code & 0x3f) + 1;
+    rgb_t rgb = BLACK;
+
+    if (count > voxels) count = voxels;           // Corrupt, stay in the cube
+    voxels -= count;
+
+    if (type == ANIMATION_RUN) {
+      rgb = RGB(pgm_read_byte(data), pgm_read_byte(data + 1), pgm_read_byte(data + 2));
+      data += sizeof(rgb_t);
+    }
+
+    while (count --) {
+      if (type != ANIMATION_SKIP) {
+        if (type == ANIMATION_LITERAL) {
+          rgb = RGB(pgm_read_byte(data), pgm_read_byte(data + 1), pgm_read_byte(data + 2));
+          data += sizeof(rgb_t);
+        }
+
+        framePut(led, x, y, z, rgb);
+        ledDrawDirty[z] = LED_DIRTY_PLANE;
+      }
+
+      if (++ x == CUBE_SIZE) {
+        x = 0;
+        if (++ y == CUBE_SIZE) {
+          y = 0;
+          z ++;
+        }
+      }
+    }
+  }
+
+  animationNext = data;
+  return(duration & ~ANIMATION_KEYFRAME);
+}
+
+boolean Cube::play(
+  const byte *animation,
+  byte        loops) {
+
+  return(cubePlay(animation, loops));
+}
+
+// Plays the animation loops times (0 is forever), starting straight away.
+// False when it was made for another size of cube.
+
+boolean cubePlay(
+  const byte *animation,
+  byte        loops) {
+
+  if (pgm_read_byte(animation + ANIMATION_EDGE) != CUBE_SIZE) return(false);
+
+  animationStart   = animation;
+  animationNext    = animation + ANIMATION_FIRST;
+  animationFrames  = animationWord(animation + ANIMATION_FRAMES);
+  animationFrame   = 0;
+  animationLoops   = loops;
+  animationDue     = millis();
+  animationPlaying = (animationFrames > 0);
+
+  cubeAnimationPoll();
+  return(true);
+}
+
+void Cube::stop() {
+  cubeStop();
+}
+
+// The frame being displayed stays displayed
+
+void cubeStop(void) {
+  animationPlaying = false;
+}
+
+boolean Cube::isPlaying() {
+  return(cubeIsPlaying());
+}
+
+boolean cubeIsPlaying(void) {
+  return(animationPlaying);
+}
+
+void cubeAnimationPoll(void) {
+  if (! animationPlaying  ||  ! cubeFrameFree()) return;
+
+  unsigned long now = millis();
+  if ((long) (now - animationDue) < 0) return;
+
+  unsigned int duration = animationDecode();
+  cubeFrameDrawn();
+
+  // Frames keep to their durations, unless poll() is called too late
+  animationDue += duration;
+  if ((long) (now - animationDue) > 0) animationDue = now;
+
+  if (++ animationFrame == animationFrames) {
+    if (animationLoops == 1) {
+      animationPlaying = false;
+      return;
+    }
+
+    if (animationLoops > 1) animationLoops --;
+    animationFrame = 0;
+    animationNext  = animationStart + ANIMATION_FIRST;
+  }
+}
+#endif
@@ -0,0 +1,46 @@
+/*
+ * File:    animation.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Animations, stored in program memory and played by Cube::poll() (see
+ * Cube::play()).  extras/host/cube4_encode turns serial commands into this
+ * format.
+ *
+ * An animation is a byte array: the CUBE_SIZE it was made for, the number of
+ * frames (16 bits, low byte first), then each frame ...
+ *
+ *   Duration in milliseconds (15 bits, low byte first), plus
+ *   ANIMATION_KEYFRAME when the frame starts from all BLACK, rather than
+ *   from the frame before.  The first frame must be a keyframe.
+ *
+ *   Codes, until every voxel of the frame has been covered, in order X
+ *   fastest, then Y, then Z ...
+ *     0nnnnnnn            Skip nnnnnnn + 1 voxels, they don't change
+ *     10nnnnnn r g b      nnnnnn + 1 voxels of one color
+ *     11nnnnnn r g b ...  nnnnnn + 1 voxels, each with its own color
+ */
+
+#ifndef ANIMATION_h
+#define ANIMATION_h
+
+static const byte ANIMATION_EDGE   = 0;             // Header byte offsets
+static const byte ANIMATION_FRAMES = 1;
+static const byte ANIMATION_FIRST  = 3;
+
+static const unsigned int ANIMATION_KEYFRAME = 0x8000;  // In the duration
+
+static const byte ANIMATION_SKIP    = 0x00;         // Code types
+static const byte ANIMATION_RUN     = 0x80;
+static const byte ANIMATION_LITERAL = 0xc0;
+
+static const byte ANIMATION_SKIP_MAX  = 128;        // Voxels per code
+static const byte ANIMATION_COLOR_MAX = 64;
+
+extern boolean cubePlay(const byte *animation, byte loops = 0);
+extern void cubeStop(void);
+extern boolean cubeIsPlaying(void);
+extern void cubeAnimationPoll(void);
+
+#endif
@@ -6,6 +6,13 @@
  *
  * Cube command engine.
  *
+ * Fades are crossfades of a box shaped region (down to a single voxel) from
+ * one colour to another over a period, run by cubeFadePoll(), which is
+ * called by cubePoll(), so that they carry on while the sketch (or the serial
+ * host) does something else.  Up to FADE_SLOTS fades run at the same time.
+ * Each tick works out how far through its period each fade is, as a fraction
+ * of 256, and only redraws the region when that has changed.
+ *
  * ToDo
  * ~~~~
  * - None, yet.
@@ -17,10 +24,199 @@
 #include "Cube.h"
 #include "engine.h"
 
+typedef struct {
+  rgb_t         colorFrom;
+  rgb_t         colorTo;
+  byte          x1, y1, z1, x2, y2, z2;
+  unsigned int  period;                           // Milliseconds
+  unsigned long start;                            // millis()
+  unsigned int  step;                             // Last drawn, 0 to 256
+  bool          active;
+}
+  fade_t;
+
+static const unsigned int FADE_UNDRAWN = 0xffff;  // fade_t step
+
+static fade_t fades[FADE_SLOTS];
+
 byte executeNop(
   bytecode_t bytecode) {
 
   byte errorCode = 0;
   return(errorCode);
 }
+
+// Starts a fade of the region from u.lit.x1, y1, z1 to x2, y2, z2 (either
+// way around) from u.lit.colorFrom to colorTo, over u.lit.period milliseconds
+// (0 sets colorTo on the next tick)
+
+byte executeFade(
+  bytecode_t bytecode) {
+
+  byte errorCode = 0;
+
+  cubeFade(
+    bytecode.u.lit.x1, bytecode.u.lit.y1, bytecode.u.lit.z1,
+    bytecode.u.lit.x2, bytecode.u.lit.y2, bytecode.u.lit.z2,
+    bytecode.u.lit.colorFrom, bytecode.u.lit.colorTo, bytecode.u.lit.period);
+
+  return(errorCode);
+}
+
+// The colour step / 256 of the way from colorFrom to colorTo
+
+static inline byte fadeChannel(
+  byte         from,
+  byte         to,
+  unsigned int step) {
+
+  return((from * (256 - step) + to * step) >> 8);
+}
+
+static void fadeDraw(
+  fade_t       *fade,
+  unsigned int  step) {
+
+  rgb_t rgb = RGB(
+    fadeChannel(fade->colorFrom.color[0], fade->colorTo.color[0], step),
+    fadeChannel(fade->colorFrom.color[1], fade->colorTo.color[1], step),
+    fadeChannel(fade->colorFrom.color[2], fade->colorTo.color[2], step));
+
+  for (byte z = fade->z1;  z <= fade->z2;  z ++) {
+    for (byte y = fade->y1;  y <= fade->y2;  y ++) {
+      for (byte x = fade->x1;  x <= fade->x2;  x ++) framePut(led, x, y, z, rgb);
+    }
+    ledDrawDirty[z] = LED_DIRTY_PLANE;
+  }
+
+  fade->step = step;
+}
+
+// Draws each fade that has moved on a step, returns true if any were drawn
+
+static bool fadeTick(
+  unsigned long now) {
+
+  bool drawn = false;
+
+  for (byte slot = 0;  slot < FADE_SLOTS;  slot ++) {
+    fade_t *fade = & fades[slot];
+    if (! fade->active) continue;
+
+    unsigned long elapsed = now - fade->start;
+    unsigned int  step    = 256;
+
+    if (elapsed < fade->period) step = (elapsed << 8) / fade->period;
+
+    if (step != fade->step) {
+      fadeDraw(fade, step);
+      drawn = true;
+    }
+
+    if (step == 256) fade->active = false;
+  }
+
+  return(drawn);
+}
+
+void Cube::fade(
+  byte         x1,
+  byte         y1,
+  byte         z1,
+  byte         x2,
+  byte         y2,
+  byte         z2,
+  rgb_t        colorFrom,
+  rgb_t        colorTo,
+  unsigned int period) {
+
+  cubeFade(x1, y1, z1, x2, y2, z2, colorFrom, colorTo, period);
+}
+
+void Cube::fade(
+  rgb_t        colorFrom,
+  rgb_t        colorTo,
+  unsigned int period) {
+
+  cubeFade(0, 0, 0, CUBE_SIZE - 1, CUBE_SIZE - 1, CUBE_SIZE - 1, colorFrom, colorTo, period);
+}
+
+// A new fade replaces any running fade of the same region.  Otherwise it
+// takes a free slot, or when there are none, the slot of the fade that
+// started first, which is finished (drawn in its final colour) straight away.
+
+void cubeFade(
+  byte         x1,
+  byte         y1,
+  byte         z1,
+  byte         x2,
+  byte         y2,
+  byte         z2,
+  rgb_t        colorFrom,
+  rgb_t        colorTo,
+  unsigned int period) {
+
+  if (x1 >= CUBE_SIZE  ||  y1 >= CUBE_SIZE  ||  z1 >= CUBE_SIZE  ||
+      x2 >= CUBE_SIZE  ||  y2 >= CUBE_SIZE  ||  z2 >= CUBE_SIZE) return;
+
+  fade_t region = {
+    colorFrom, colorTo,
+    min(x1, x2), min(y1, y2), min(z1, z2), max(x1, x2), max(y1, y2), max(z1, z2),
+    period, millis(), FADE_UNDRAWN, true
+  };
+
+  fade_t *fade = NULL;
+
+  for (byte slot = 0;  slot < FADE_SLOTS  &&  fade == NULL;  slot ++) {
+    if (fades[slot].active  &&
+        fades[slot].x1 == region.x1  &&  fades[slot].y1 == region.y1  &&  fades[slot].z1 == region.z1  &&
+        fades[slot].x2 == region.x2  &&  fades[slot].y2 == region.y2  &&  fades[slot].z2 == region.z2) {
+
+      fade = & fades[slot];
+    }
+  }
+
+  for (byte slot = 0;  slot < FADE_SLOTS  &&  fade == NULL;  slot ++) {
+    if (! fades[slot].active) fade = & fades[slot];
+  }
+
+  if (fade == NULL) {
+    fade = & fades[0];
+    for (byte slot = 1;  slot < FADE_SLOTS;  slot ++) {
+      if ((long) (fades[slot].start - fade->start) < 0) fade = & fades[slot];
+    }
+
+    fadeDraw(fade, 256);
+  }
+
+  *fade = region;                                 // Drawn by the next tick
+}
+
+boolean Cube::isFading() {
+  return(cubeIsFading());
+}
+
+boolean cubeIsFading(void) {
+  for (byte slot = 0;  slot < FADE_SLOTS;  slot ++) {
+    if (fades[slot].active) return(true);
+  }
+
+  return(false);
+}
+
+void Cube::fadeStop() {
+  cubeFadeStop();
+}
+
+// The fades stop where they are
+
+void cubeFadeStop(void) {
+  for (byte slot = 0;  slot < FADE_SLOTS;  slot ++) fades[slot].active = false;
+}
+
+void cubeFadePoll(void) {
+  if (! cubeIsFading()  ||  ! cubeFrameFree()) return;
+
+  if (fadeTick(millis())) cubeFrameDrawn();
+}
 #endif
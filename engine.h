@@ -19,7 +19,8 @@ typedef struct bytecode_s {
     struct {
       rgb_t colorFrom;
       rgb_t colorTo;
-      byte period;
+      unsigned int period;          // Milliseconds, see executeFade()
+      byte x1, y1, z1, x2, y2, z2;  // Region, see executeFade()
     } lit;
 
     struct reset {};
@@ -28,9 +29,9 @@ typedef struct bytecode_s {
   }
     u;
 }
-  bytecode_t;  // 9 bytes
+  bytecode_t;  // 16 bytes
 
-// bytecode_ sequence[50];  // 450 bytes
+// bytecode_ sequence[50];  // 800 bytes
 
 // byte sequenceCount = 0;
 // byte sequenceLength = sizeof(sequence) / sizeof(bytecode_t);
@@ -38,5 +39,15 @@ typedef struct bytecode_s {
 // byte sequenceRunning = false;
 // byte sequenceStep = 0;
 
+// Fades run at the same time, see executeFade()
+
+static const byte FADE_SLOTS = 4;
+
 byte executeNop(bytecode_t bytecode);
+byte executeFade(bytecode_t bytecode);
+
+extern void cubeFade(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t colorFrom, rgb_t colorTo, unsigned int period);
+extern boolean cubeIsFading(void);
+extern void cubeFadeStop(void);
+extern void cubeFadePoll(void);
 #endif
@@ -26,6 +26,9 @@ void setup(void) {
 }
 
 void loop(void) {
+  // Run any serial commands that have been received
+  cube.poll();
+
   int zReading = analogRead(A2);
   if(zReading > 300)
   {
@@ -0,0 +1,58 @@
+/*
+ * File:    Animation.ino
+ * Version: 1.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ */
+
+/*
+ * Coloured planes rise through the cube, then a red, orange and yellow
+ * sphere grows from a corner.  The animation is stored in program memory and
+ * played by cube.poll() (called by delay()), so loop() is free to do other
+ * things while it plays.
+ *
+ * The array was made from serial commands by extras/host/cube4_encode ...
+ *
+ *   all black; setplane z 0 blue; frame 150;
+ *   setplane z 0 black; setplane z 1 00ffff; frame 150;
+ *   setplane z 1 black; setplane z 2 green; frame 150;
+ *   setplane z 2 black; setplane z 3 yellow; frame 150;
+ *   setplane z 3 black; sphere 000 2 red; frame 150;
+ *   sphere 000 3 orange; frame 150;
+ *   sphere 000 4 yellow; frame 150;
+ *   all black; set 333 white; frame 300;
+ */
+
+#include "SPI.h"
+#include "Cube.h"
+
+Cube cube;
+
+// 8 frames for a 4x4x4 cube, 125 bytes (1536 bytes uncompressed)
+const byte rising[] PROGMEM = {
+  0x04, 0x08, 0x00, 0x96, 0x80, 0x8f, 0x00, 0x00, 0xff, 0x2f, 0x96, 0x80,
+  0x0f, 0x8f, 0x00, 0xff, 0xff, 0x1f, 0x96, 0x80, 0x1f, 0x8f, 0x00, 0xff,
+  0x00, 0x0f, 0x96, 0x80, 0x2f, 0x8f, 0xff, 0xff, 0x00, 0x96, 0x80, 0x81,
+  0xff, 0x00, 0x00, 0x01, 0x81, 0xff, 0x00, 0x00, 0x09, 0x81, 0xff, 0x00,
+  0x00, 0x01, 0x81, 0xff, 0x00, 0x00, 0x29, 0x96, 0x00, 0xc1, 0x00, 0x00,
+  0x00, 0xff, 0x45, 0x00, 0x01, 0xc0, 0xff, 0x45, 0x00, 0x0a, 0xc0, 0xff,
+  0x45, 0x00, 0x2e, 0x96, 0x80, 0x01, 0xc0, 0xff, 0xff, 0x00, 0x02, 0xc0,
+  0xff, 0xff, 0x00, 0x00, 0x81, 0xff, 0xff, 0x00, 0x07, 0xc0, 0xff, 0xff,
+  0x00, 0x02, 0xc0, 0xff, 0xff, 0x00, 0x00, 0x81, 0xff, 0xff, 0x00, 0x05,
+  0x81, 0xff, 0xff, 0x00, 0x01, 0x81, 0xff, 0xff, 0x00, 0x19, 0x2c, 0x81,
+  0x3e, 0xc0, 0xff, 0xff, 0xff
+};
+
+void setup(void) {
+  // Serial port options for control of the Cube using serial commands are:
+  // 0: Control via the USB connector (most common).
+  // 1: Control via the RXD and TXD pins on the main board.
+  // -1: Don't attach any serial port to interact with the Cube.
+  cube.begin(0, 115200); // Start on serial port 0 (USB) at 115200 baud
+
+  cube.play(rising);     // Loops forever, use cube.play(rising, 3); for 3 times
+}
+
+void loop(void) {
+  delay(10);
+}
@@ -0,0 +1,59 @@
+/*
+ * File:    Benchmark.ino
+ * Version: 1.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Times the graphics primitives and prints CPU cycles per call as CSV, e.g.
+ *   primitive,args,cycles_per_call
+ *   line,diagonal,2345
+ * LED updates are suspended while timing, so the refresh interrupt doesn't
+ * inflate the results, and the empty "baseline" call is subtracted.
+ */
+
+#include "SPI.h"
+#include "Cube.h"
+#include "benchmarks.h"
+
+static const unsigned int CALLS = 200;
+
+Cube cube;
+
+unsigned long cyclesPerCall(
+  void (*run)(void)) {
+
+  unsigned long start = micros();
+  for (unsigned int count = 0;  count < CALLS;  count ++) run();
+  unsigned long elapsed = micros() - start;
+
+  return(elapsed * (F_CPU / 1000000L) / CALLS);
+}
+
+void setup(void) {
+#if defined(ARDUINO) && ARDUINO >= 101
+  while (Serial == false) ;                 // Wait for Leonardo USB serial port
+#endif
+
+  cube.begin(0, 115200);
+  delay(1000);
+}
+
+void loop(void) {
+  cube.suspend();
+  unsigned long baseline = cyclesPerCall(benchmarks[0].run);
+
+  serial->println(F("primitive,args,cycles_per_call"));
+
+  for (byte index = 1;  index < BENCHMARK_COUNT;  index ++) {
+    unsigned long cycles = cyclesPerCall(benchmarks[index].run);
+
+    serial->print(benchmarks[index].name);
+    serial->print(',');
+    serial->print(benchmarks[index].args);
+    serial->print(',');
+    serial->println(cycles > baseline  ?  cycles - baseline  :  0);
+  }
+
+  cube.resume();
+  delay(10000);
+}
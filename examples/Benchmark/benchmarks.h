@@ -0,0 +1,100 @@
+/*
+ * File:    benchmarks.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Graphics primitive benchmark cases, shared by the Benchmark sketch (cycles
+ * per call on the Cube) and extras/bench/cube4_bench.cpp (ns per call on the
+ * host), so that both report the same set of results.
+ */
+
+#ifndef BENCHMARKS_h
+#define BENCHMARKS_h
+
+typedef struct {
+  const char *name;
+  const char *args;
+  void (*run)(void);
+}
+  benchmark_t;
+
+static const byte LAST = CUBE_SIZE - 1;
+
+static void benchBaseline(void) {}
+
+static void benchAll(void)          { cubeAll(BLUE); }
+static void benchSetplaneX(void)    { cubeSetplane(X, 1, RED); }
+static void benchSetplaneZ(void)    { cubeSetplane(Z, 1, RED); }
+
+static void benchLineAxis(void)     { cubeLine(0, 0, 0, LAST, 0, 0, RED); }
+static void benchLineDiagonal(void) { cubeLine(0, 0, 0, LAST, LAST, LAST, RED); }
+static void benchLineSkew(void)     { cubeLine(0, 1, LAST, LAST, 0, 1, RED); }
+static void benchLinePoint(void)    { cubeLine(1, 1, 1, 1, 1, 1, RED); }
+static void benchLineThick(void)    { cubeLine(0, 1, 1, LAST, 1, 1, RED, 2); }
+
+static void benchTriangleFlat(void) { cubeTriangle(0, 0, 0, LAST, 0, 0, 0, LAST, 0, RED); }
+static void benchTriangleTilt(void) { cubeTriangle(0, 0, 0, LAST, 0, LAST, 0, LAST, LAST, RED); }
+static void benchQuadTilt(void)     { cubeQuad(0, 0, 0, LAST, 0, 0, LAST, LAST, LAST, 0, LAST, LAST, RED); }
+
+static void benchBoxSolid(void)     { cubeBox(0, 0, 0, LAST, LAST, LAST, RED, 0); }
+static void benchBoxWalls(void)     { cubeBox(0, 0, 0, LAST, LAST, LAST, RED, 1); }
+static void benchBoxEdges(void)     { cubeBox(0, 0, 0, LAST, LAST, LAST, RED, 2); }
+static void benchBoxFilled(void)    { cubeBox(0, 0, 0, LAST, LAST, LAST, RED, 4, BLUE); }
+static void benchBoxInner(void)     { cubeBox(1, 1, 1, 2, 2, 2, RED, 0); }
+
+static void benchSphereFull(void)   { cubeSphere(0, 0, 0, CUBE_SIZE, RED, BLUE); }
+static void benchSphereSmall(void)  { cubeSphere(1, 1, 1, 2, RED); }
+static void benchEllipsoid(void)    { cubeEllipsoid(1, 1, 1, 2 * CUBE_SIZE, CUBE_SIZE, 3, RED, 1); }
+
+static void benchShiftX(void)       { cubeShift(X, '+'); }
+static void benchShiftZ(void)       { cubeShift(Z, '-'); }
+
+static void benchRotateZ(void)      { cubeRotate(Z, 1); }
+static void benchMirrorX(void)      { cubeMirror(X); }
+static void benchTransposeXZ(void)  { cubeTranspose(X, Z); }
+
+#ifdef CUBE_PARTICLES
+// Emitter 0 is all zero until set, so each particle lives for one step
+static void benchParticles(void)    { cubeParticleBurst(0, CUBE_PARTICLES);  cubeParticleStep(); }
+#endif
+
+static void benchCopyplaneX(void)   { cubeCopyplane(X, 0, LAST); }
+static void benchCopyplaneZ(void)   { cubeCopyplane(Z, 0, LAST); }
+
+static const benchmark_t benchmarks[] = {
+  { "baseline",  "",                benchBaseline     },
+  { "all",       "",                benchAll          },
+  { "setplane",  "X",               benchSetplaneX    },
+  { "setplane",  "Z",               benchSetplaneZ    },
+  { "line",      "axis",            benchLineAxis     },
+  { "line",      "diagonal",        benchLineDiagonal },
+  { "line",      "skew",            benchLineSkew     },
+  { "line",      "point",           benchLinePoint    },
+  { "line",      "thick 2",         benchLineThick    },
+  { "triangle",  "flat",            benchTriangleFlat },
+  { "triangle",  "sloping",         benchTriangleTilt },
+  { "quad",      "sloping",         benchQuadTilt     },
+  { "box",       "full solid",      benchBoxSolid     },
+  { "box",       "full walls",      benchBoxWalls     },
+  { "box",       "full edges",      benchBoxEdges     },
+  { "box",       "full edges fill", benchBoxFilled    },
+  { "box",       "inner 2 solid",   benchBoxInner     },
+  { "sphere",    "full fill",       benchSphereFull   },
+  { "sphere",    "size 2",          benchSphereSmall  },
+  { "ellipsoid", "hollow clipped",  benchEllipsoid    },
+  { "shift",     "X +",             benchShiftX       },
+  { "shift",     "Z -",             benchShiftZ       },
+  { "rotate",    "Z 1",             benchRotateZ      },
+  { "mirror",    "X",               benchMirrorX      },
+  { "transpose", "X Z",             benchTransposeXZ  },
+#ifdef CUBE_PARTICLES
+  { "particles", "pool full",       benchParticles    },
+#endif
+  { "copyplane", "X",               benchCopyplaneX   },
+  { "copyplane", "Z",               benchCopyplaneZ   }
+};
+
+static const byte BENCHMARK_COUNT = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+#endif
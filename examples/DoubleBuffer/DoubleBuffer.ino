@@ -0,0 +1,47 @@
+/*
+ * File:    DoubleBuffer.ino
+ * Version: 1.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ */
+
+/*
+ * Each frame of this animation is built from several commands. With double
+ * buffering turned on the frame is drawn in a hidden buffer, and only shown
+ * once it is complete, so there is no flicker or half drawn frames and no
+ * need to suspend the cube while drawing.
+ */
+
+#include "SPI.h"
+#include "Cube.h"
+
+#define DELAY 150
+
+Cube cube;
+
+byte position = 0;
+
+void setup(void) {
+  // Serial port options for control of the Cube using serial commands are:
+  // 0: Control via the USB connector (most common).
+  // 1: Control via the RXD and TXD pins on the main board.
+  // -1: Don't attach any serial port to interact with the Cube.
+  cube.begin(0, 115200); // Start on serial port 0 (USB) at 115200 baud
+
+  cube.doubleBuffer(true);
+}
+
+void loop(void) {
+  // Draw the next frame in the back buffer
+  cube.all(BLACK);
+  cube.setplane(Z, position, BLUE);
+  cube.box(0, 0, 0, 3, 3, 3, WHITE, 2);
+  cube.line(0, 0, position, 3, 3, 3 - position, RED);
+
+  // Display it, and wait until it is on the LEDs before drawing the next one
+  cube.show();
+  cube.waitForShow();
+
+  position = (position + 1) % 4;
+  delay(DELAY);
+}
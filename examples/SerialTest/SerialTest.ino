@@ -23,4 +23,6 @@ void setup(void) {
 }
 
 void loop(void) {
+  // Run any serial commands that have been received
+  cube.poll();
 }
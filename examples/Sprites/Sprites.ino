@@ -0,0 +1,72 @@
+/*
+ * File:    Sprites.ino
+ * Version: 1.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ */
+
+/*
+ * A ship flies back and forth through the cube while a rock drifts down
+ * through it.  Each object is a sprite stored in program memory and drawn
+ * with a single command, and the ship flashes white whenever it hits the
+ * rock.
+ */
+
+#include "SPI.h"
+#include "Cube.h"
+
+#define DELAY 200
+
+Cube cube;
+
+// Sizes along X, Y and Z, then the colour of each voxel, X fastest.  BLACK
+// voxels aren't drawn.
+
+const byte ship[] PROGMEM = {
+  2, 1, 2,
+  0x00, 0x00, 0xff,   0x00, 0x00, 0xff,
+  0x00, 0x00, 0x00,   0xff, 0xff, 0x00
+};
+
+const byte rock[] PROGMEM = {
+  2, 2, 1,
+  0x40, 0x20, 0x00,   0x80, 0x40, 0x00,
+  0x00, 0x00, 0x00,   0x40, 0x20, 0x00
+};
+
+int shipX = -2;
+int shipStep = 1;
+int rockZ = 4;
+
+void setup(void) {
+  // Serial port options for control of the Cube using serial commands are:
+  // 0: Control via the USB connector (most common).
+  // 1: Control via the RXD and TXD pins on the main board.
+  // -1: Don't attach any serial port to interact with the Cube.
+  cube.begin(0, 115200); // Start on serial port 0 (USB) at 115200 baud
+
+  cube.doubleBuffer(true);
+}
+
+void loop(void) {
+  cube.all(BLACK);
+  cube.sprite(rock, 1, 1, rockZ);
+
+  // Sprites can be partly, or completely, outside the cube
+  if (cube.spriteCollision(ship, shipX, 1, 1, rock, 1, 1, rockZ)) {
+    cube.spriteColor(ship, shipX, 1, 1, WHITE);
+  }
+  else {
+    cube.sprite(ship, shipX, 1, 1);
+  }
+
+  cube.show();
+  cube.waitForShow();
+
+  shipX += shipStep;
+  if (shipX < -2  ||  shipX > CUBE_SIZE) shipStep = -shipStep;
+
+  rockZ = (rockZ > -1)  ?  rockZ - 1  :  CUBE_SIZE;
+
+  delay(DELAY);
+}
@@ -29,4 +29,6 @@ void setup(void) {
 }
 
 void loop(void) {
+  // Run any serial commands that have been received
+  cube.poll();
 }
@@ -105,6 +105,10 @@ void userFunctionHandler(int itemID, rgb_t selectedColour)
 }
 
 void loop(void) {
+  // Run any serial commands that have been received. The animations below
+  // don't call delay(), which would otherwise do this automatically
+  cube.poll();
+
   if (!cube.hasReceivedSerialCommand())
   {
     // User hasn't sent a serial command, so just flash a 
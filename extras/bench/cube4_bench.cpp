@@ -0,0 +1,94 @@
+/*
+ * File:    cube4_bench.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Runs the graphics primitive benchmarks (examples/Benchmark/benchmarks.h)
+ * on the host and prints nanoseconds per call as CSV, e.g.
+ *   primitive,args,ns_per_call
+ *   line,diagonal,123.4
+ * Each case is timed several times and the fastest run is reported, with
+ * the empty "baseline" call subtracted.
+ *
+ * Usage: cube4_bench [-m milliseconds per run] [-n runs] [-o file]
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "Cube.h"
+#include "benchmarks.h"
+
+Cube cube;
+
+static double nsPerCall(
+  void (*run)(void),
+  unsigned long milliseconds,
+  unsigned int  runs) {
+
+  typedef std::chrono::steady_clock clock;
+
+  // Find a call count that takes roughly the requested time
+  unsigned long calls = 16;
+  while (true) {
+    clock::time_point start = clock::now();
+    for (unsigned long count = 0;  count < calls;  count ++) run();
+    double elapsed = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    if (elapsed >= milliseconds / 4.0  ||  calls >= (1UL << 30)) break;
+    calls *= 2;
+  }
+
+  double best = 0;
+  for (unsigned int index = 0;  index < runs;  index ++) {
+    clock::time_point start = clock::now();
+    for (unsigned long count = 0;  count < calls;  count ++) run();
+    double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / calls;
+    if (index == 0  ||  ns < best) best = ns;
+  }
+
+  return(best);
+}
+
+int main(int argc, char *argv[]) {
+  unsigned long milliseconds = 50;
+  unsigned int  runs = 5;
+  FILE *output = stdout;
+  int option;
+
+  while ((option = getopt(argc, argv, "m:n:o:")) != -1) {
+    switch (option) {
+      case 'm': milliseconds = strtoul(optarg, NULL, 0);  break;
+      case 'n': runs = strtoul(optarg, NULL, 0);          break;
+      case 'o':
+        output = fopen(optarg, "w");
+        if (output == NULL) {
+          perror(optarg);
+          return(1);
+        }
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-m milliseconds] [-n runs] [-o file]\n", argv[0]);
+        return(1);
+    }
+  }
+  if (runs == 0) runs = 1;
+
+  hal_reset();
+  cube.begin(-1);
+
+  double baseline = nsPerCall(benchmarks[0].run, milliseconds, runs);
+
+  fprintf(output, "primitive,args,ns_per_call\n");
+
+  for (byte index = 1;  index < BENCHMARK_COUNT;  index ++) {
+    double ns = nsPerCall(benchmarks[index].run, milliseconds, runs) - baseline;
+
+    fprintf(output, "%s,%s,%.1f\n",
+      benchmarks[index].name, benchmarks[index].args, ns > 0  ?  ns  :  0.0);
+  }
+
+  if (output != stdout) fclose(output);
+  return(0);
+}
@@ -0,0 +1,121 @@
+/*
+ * File:    Arduino.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host HAL: the subset of the Arduino core used by the library and examples.
+ * Pin numbers follow the Leonardo (ATmega32U4) variant.
+ */
+
+#ifndef HAL_Arduino_h
+#define HAL_Arduino_h
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "hal.h"
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define B00001111 0x0f
+#define B11110000 0xf0
+
+static const uint8_t SCK  = 15;
+static const uint8_t MOSI = 16;
+static const uint8_t MISO = 14;
+static const uint8_t A0 = 18, A1 = 19, A2 = 20, A3 = 21, A4 = 22, A5 = 23;
+
+// Analog input (0 for A0) to ADC channel, as in the Leonardo pins_arduino.h
+static const uint8_t analog_pin_to_channel_PGM[] = { 7, 6, 5, 4, 1, 0, 8, 10, 11, 12, 13, 9 };
+#define analogPinToChannel(P) (analog_pin_to_channel_PGM[P])
+
+// Macros, as in the AVR core, so include any C++ standard headers first
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define constrain(amount, low, high) \
+  ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+#define isDigit(c) (isdigit(c) != 0)
+
+extern unsigned long millis(void);
+extern unsigned long micros(void);
+extern void delay(unsigned long ms);
+extern void delayMicroseconds(unsigned int us);
+extern void yield(void);
+
+extern void pinMode(uint8_t pin, uint8_t mode);
+extern void digitalWrite(uint8_t pin, uint8_t value);
+extern int  analogRead(uint8_t pin);
+
+extern long random(long howBig);
+extern long random(long howSmall, long howBig);
+extern void randomSeed(unsigned long seed);
+
+// Print and Stream
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t character) = 0;
+
+    size_t print(const __FlashStringHelper *string);
+    size_t print(const char *string);
+    size_t print(char character);
+    size_t print(int number);
+    size_t print(unsigned int number);
+    size_t print(long number);
+    size_t print(unsigned long number);
+    size_t print(double number, int digits = 2);
+
+    size_t println(void);
+    template <class T> size_t println(T value) { return print(value) + println(); }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available(void) = 0;
+    virtual int read(void) = 0;
+    virtual int peek(void) = 0;
+};
+
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud) { (void) baud; }
+    void end(void) {}
+    operator bool(void) { return true; }
+
+    int available(void);
+    int read(void);
+    int peek(void);
+    size_t write(uint8_t character);
+
+    std::deque<uint8_t> input;
+    std::string         output;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,28 @@
+/*
+ * File:    SPI.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host HAL: SPI bytes are written to SPDR, where they can be observed.
+ */
+
+#ifndef HAL_SPI_h
+#define HAL_SPI_h
+
+#include <avr/io.h>
+
+class SPIClass {
+  public:
+    static void begin(void) { SPCR |= _BV(MSTR) | _BV(SPE); }
+    static void end(void)   { SPCR &= ~_BV(SPE); }
+
+    static uint8_t transfer(uint8_t data) {
+      SPDR = data;
+      return 0;
+    }
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * File:    animation_encode.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host side animation encoder, see animation.h for the format.  Used by
+ * cube4_encode and the animation test.
+ *
+ * Each frame is encoded against the frame before, and also as a keyframe
+ * (against all BLACK), and the shorter of the two is kept.  The first frame,
+ * and every keyframeInterval frames (if not 0), are always keyframes.
+ *
+ * Include <vector> before Cube.h, whose min() and max() macros break it.
+ */
+
+#ifndef ANIMATION_ENCODE_h
+#define ANIMATION_ENCODE_h
+
+#include <vector>
+
+#include "Cube.h"
+
+static const unsigned int ANIMATION_VOXELS = CUBE_SIZE * PLANE_VOXELS;
+
+typedef std::vector<rgb_t> animation_frame_t;     // X fastest, then Y, then Z
+
+typedef struct {
+  animation_frame_t voxels;
+  unsigned int      duration;                     // Milliseconds, up to 32767
+}
+  animation_source_t;
+
+static inline bool animationSame(
+  const rgb_t &a,
+  const rgb_t &b) {
+
+  return(memcmp(& a, & b, sizeof(rgb_t)) == 0);
+}
+
+// The frame as it is stored in a frame buffer
+
+static inline animation_frame_t animationCapture(
+  frame_t *frame) {
+
+  animation_frame_t voxels;
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte x = 0;  x < CUBE_SIZE;  x ++) voxels.push_back(frameGet(frame, x, y, z));
+    }
+  }
+
+  return(voxels);
+}
+
+static inline void animationPutColor(
+  std::vector<byte> &data,
+  const rgb_t       &rgb) {
+
+  data.insert(data.end(), rgb.color, rgb.color + sizeof(rgb_t));
+}
+
+// The codes that turn before into frame
+
+static inline std::vector<byte> animationCodes(
+  const animation_frame_t &before,
+  const animation_frame_t &frame) {
+
+  std::vector<byte> data;
+  unsigned int voxel = 0;
+
+  while (voxel < ANIMATION_VOXELS) {
+    unsigned int count = 1;
+
+    if (animationSame(frame[voxel], before[voxel])) {
+      while (voxel + count < ANIMATION_VOXELS  &&  count < ANIMATION_SKIP_MAX  &&
+             animationSame(frame[voxel + count], before[voxel + count])) count ++;
+
+      data.push_back(ANIMATION_SKIP | (count - 1));
+    }
+    else {
+      while (voxel + count < ANIMATION_VOXELS  &&  count < ANIMATION_COLOR_MAX  &&
+             animationSame(frame[voxel + count], frame[voxel])) count ++;
+
+      if (count > 1) {
+        data.push_back(ANIMATION_RUN | (count - 1));
+        animationPutColor(data, frame[voxel]);
+      }
+      else {
+        // Changed voxels up to the next unchanged one, or the next run
+
+        while (voxel + count < ANIMATION_VOXELS  &&  count < ANIMATION_COLOR_MAX  &&
+               ! animationSame(frame[voxel + count], before[voxel + count])  &&
+               ! (voxel + count + 1 < ANIMATION_VOXELS  &&
+                  animationSame(frame[voxel + count], frame[voxel + count + 1]))) count ++;
+
+        data.push_back(ANIMATION_LITERAL | (count - 1));
+        for (unsigned int index = 0;  index < count;  index ++) animationPutColor(data, frame[voxel + index]);
+      }
+    }
+
+    voxel += count;
+  }
+
+  return(data);
+}
+
+static inline std::vector<byte> animationEncode(
+  const std::vector<animation_source_t> &frames,
+  unsigned int                           keyframeInterval = 0) {
+
+  std::vector<byte> data;
+  animation_frame_t black(ANIMATION_VOXELS, BLACK);
+
+  data.push_back(CUBE_SIZE);
+  data.push_back(frames.size() & 0xff);
+  data.push_back(frames.size() >> 8);
+
+  for (unsigned int index = 0;  index < frames.size();  index ++) {
+    const animation_frame_t &frame = frames[index].voxels;
+    std::vector<byte> codes = animationCodes(black, frame);
+    unsigned int duration = (frames[index].duration & ~ANIMATION_KEYFRAME) | ANIMATION_KEYFRAME;
+
+    bool keyframe = (index == 0)  ||  (keyframeInterval > 0  &&  index % keyframeInterval == 0);
+
+    if (! keyframe) {
+      std::vector<byte> delta = animationCodes(frames[index - 1].voxels, frame);
+
+      if (delta.size() < codes.size()) {
+        codes = delta;
+        duration &= ~ANIMATION_KEYFRAME;
+      }
+    }
+
+    data.push_back(duration & 0xff);
+    data.push_back(duration >> 8);
+    data.insert(data.end(), codes.begin(), codes.end());
+  }
+
+  return(data);
+}
+
+#endif
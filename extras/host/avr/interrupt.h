@@ -0,0 +1,24 @@
+/*
+ * File:    avr/interrupt.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host HAL: interrupt vectors are plain functions, run by hal_run() and
+ * hal_service_interrupts().  Nothing is concurrent, so cli() and sei() do
+ * nothing.
+ */
+
+#ifndef HAL_AVR_INTERRUPT_h
+#define HAL_AVR_INTERRUPT_h
+
+#define ISR(vector) extern "C" void vector(void)
+
+extern "C" void TIMER1_OVF_vect(void) __attribute__((weak));
+extern "C" void SPI_STC_vect(void)    __attribute__((weak));
+extern "C" void ADC_vect(void)        __attribute__((weak));
+
+static inline void cli(void) {}
+static inline void sei(void) {}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * File:    avr/io.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host HAL: simulated ATmega32U4 registers, only those used by the library.
+ */
+
+#ifndef HAL_AVR_IO_h
+#define HAL_AVR_IO_h
+
+#include "../hal.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000L
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+extern hal_register PORTB, PORTD, PORTE;
+extern hal_register SPCR, SPSR, SPDR;
+extern hal_register TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern hal_register ADMUX, ADCSRA, ADCSRB, ADCH, ADCL;
+extern hal_register SREG;
+
+extern volatile uint16_t ICR1;
+extern volatile uint16_t TCNT1;
+
+// SPCR, SPSR
+
+#define SPR0  0
+#define SPR1  1
+#define CPHA  2
+#define CPOL  3
+#define MSTR  4
+#define DORD  5
+#define SPE   6
+#define SPIE  7
+#define SPI2X 0
+#define SPIF  7
+
+// TCCR1B, TIMSK1, TIFR1
+
+#define CS10  0
+#define CS11  1
+#define CS12  2
+#define WGM12 3
+#define WGM13 4
+#define TOIE1 0
+#define TOV1  0
+#define ICF1  5
+
+// ADMUX, ADCSRA, ADCSRB
+
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE  3
+#define ADIF  4
+#define ADATE 5
+#define ADSC  6
+#define ADEN  7
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define MUX5  5
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * File:    avr/pgmspace.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host HAL: program memory is ordinary memory.
+ */
+
+#ifndef HAL_AVR_PGMSPACE_h
+#define HAL_AVR_PGMSPACE_h
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+#define pgm_read_ptr(address)  (*(const void * const *) (address))
+
+#define memcpy_P(destination, source, length) memcpy((destination), (source), (length))
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * File:    cube4_encode.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Turns serial commands into an animation for Cube::play(), printed as a
+ * PROGMEM array to include in a sketch.  The commands are read from a file
+ * (or stdin) and run by the library, as they would be on the Cube, except
+ * for 'frame <milliseconds>;', which adds the LEDs as they are then as a
+ * frame of the animation, displayed for that long, e.g.
+ *
+ *   all BLACK;  set 000 RED;  frame 100;
+ *   shift X +;  frame 100;
+ *
+ * Usage: cube4_encode [-n name] [-k keyframe interval] [file]
+ *   -n  Name of the array (default animation)
+ *   -k  Make every k-th frame a keyframe (default 0, only where smaller)
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "Cube.h"
+#include "animation_encode.h"
+
+Cube cube;
+
+int main(int argc, char *argv[]) {
+  const char *name = "animation";
+  unsigned int keyframeInterval = 0;
+  int option;
+
+  while ((option = getopt(argc, argv, "n:k:")) != -1) {
+    switch (option) {
+      case 'n': name = optarg;                                  break;
+      case 'k': keyframeInterval = strtoul(optarg, NULL, 0);    break;
+      default:
+        fprintf(stderr, "Usage: %s [-n name] [-k keyframe interval] [file]\n", argv[0]);
+        return(1);
+    }
+  }
+
+  FILE *file = optind < argc  ?  fopen(argv[optind], "r")  :  stdin;
+  if (file == NULL) {
+    perror(argv[optind]);
+    return(1);
+  }
+
+  std::string commands;
+  char buffer[256];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    commands.append(buffer, length);
+  }
+  if (file != stdin) fclose(file);
+
+  hal_reset();
+  cube.begin(-1);
+
+  std::vector<animation_source_t> frames;
+  size_t start = 0;
+
+  while (start < commands.size()) {
+    size_t end = commands.find_first_of(";\r", start);
+    if (end == std::string::npos) end = commands.size();
+
+    std::string command = commands.substr(start, end - start);
+    start = end + 1;
+
+    for (size_t index = 0;  index < command.size();  index ++) {
+      if (command[index] == '\n'  ||  command[index] == '\t') command[index] = ' ';
+    }
+
+    size_t first = command.find_first_not_of(' ');
+    if (first == std::string::npos) continue;
+    command.erase(0, first);
+
+    unsigned long duration;
+    if (sscanf(command.c_str(), "frame %lu", & duration) == 1) {
+      if (duration >= ANIMATION_KEYFRAME) {
+        fprintf(stderr, "frame %lu: durations must be less than %u milliseconds\n", duration, ANIMATION_KEYFRAME);
+        return(1);
+      }
+
+      animation_source_t frame = { animationCapture(led), (unsigned int) duration };
+      frames.push_back(frame);
+      continue;
+    }
+
+    bytecode_t bytecode = {};
+    if (parser(& command[0], command.size(), & bytecode) != 0) {
+      fprintf(stderr, "command not understood: %s\n", command.c_str());
+      return(1);
+    }
+  }
+
+  if (frames.empty()  ||  frames.size() > 0xffff) {
+    fprintf(stderr, "an animation needs 1 to 65535 frames, found %zu\n", frames.size());
+    return(1);
+  }
+
+  std::vector<byte> data = animationEncode(frames, keyframeInterval);
+
+  printf("// %zu frames for a %dx%dx%d cube, %zu bytes (%zu bytes uncompressed)\n",
+    frames.size(), CUBE_SIZE, CUBE_SIZE, CUBE_SIZE, data.size(), frames.size() * ANIMATION_VOXELS * sizeof(rgb_t));
+  printf("const byte %s[] PROGMEM = {", name);
+
+  for (size_t index = 0;  index < data.size();  index ++) {
+    printf("%s0x%02x", (index % 12)  ?  ", "  :  (index  ?  ",\n  "  :  "\n  "), data[index]);
+  }
+
+  printf("\n};\n");
+  return(0);
+}
@@ -0,0 +1,95 @@
+/*
+ * File:    cube4_sim.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Runs the Cube library on the host, as a sketch that only calls
+ * cube.poll().  Serial commands are read from a file (or stdin) and fed to
+ * serial port 0, the refresh interrupt runs in simulated time and finally the
+ * displayed frame is printed.  Handy for profiling the library with perf or
+ * valgrind.
+ *
+ * Usage: cube4_sim [-r repeat] [-t milliseconds] [-q] [file]
+ *   -r  Send the commands this many times (default 1)
+ *   -t  Keep running for this long after the last command (default 100 ms)
+ *   -q  Don't print the serial output or the frame
+ */
+
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+#include "Cube.h"
+
+static const unsigned long LOOP_CYCLES = 200;  // Time taken by each loop()
+
+Cube cube;
+
+static void printFrame(void) {
+  for (int z = CUBE_SIZE - 1;  z >= 0;  z --) {
+    printf("z=%d\n", z);
+    for (int y = CUBE_SIZE - 1;  y >= 0;  y --) {
+      for (int x = 0;  x < CUBE_SIZE;  x ++) {
+        rgb_t rgb = frameGet(ledDisplay, x, y, z);
+        printf(" %02x%02x%02x", rgb.color[0], rgb.color[1], rgb.color[2]);
+      }
+      printf("\n");
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  unsigned long repeat = 1;
+  unsigned long linger = 100;
+  bool quiet = false;
+  int option;
+
+  while ((option = getopt(argc, argv, "r:t:q")) != -1) {
+    switch (option) {
+      case 'r': repeat = strtoul(optarg, NULL, 0);  break;
+      case 't': linger = strtoul(optarg, NULL, 0);  break;
+      case 'q': quiet = true;                       break;
+      default:
+        fprintf(stderr, "Usage: %s [-r repeat] [-t milliseconds] [-q] [file]\n", argv[0]);
+        return(1);
+    }
+  }
+
+  FILE *file = optind < argc  ?  fopen(argv[optind], "r")  :  stdin;
+  if (file == NULL) {
+    perror(argv[optind]);
+    return(1);
+  }
+
+  std::string commands;
+  char buffer[256];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    commands.append(buffer, length);
+  }
+  if (file != stdin) fclose(file);
+
+  hal_reset();
+  hal_serial_echo = ! quiet;
+  cube.begin(0, 115200);
+
+  for (unsigned long count = 0;  count < repeat;  count ++) {
+    hal_serial_input(&Serial, commands.c_str());
+
+    while (Serial.available()) {
+      cube.poll();
+      hal_run(LOOP_CYCLES);
+    }
+  }
+
+  unsigned long end = millis() + linger;
+  while ((long) (millis() - end) < 0) {
+    cube.poll();
+    hal_run(LOOP_CYCLES);
+  }
+
+  if (! quiet) printFrame();
+  fprintf(stderr, "%lu refresh interrupts, %lu ms\n", hal_ticks, millis());
+  return(0);
+}
@@ -0,0 +1,360 @@
+/*
+ * File:    hal.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ */
+
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "SPI.h"
+
+hal_register PORTB("PORTB"), PORTD("PORTD"), PORTE("PORTE");
+hal_register SPCR("SPCR"), SPSR("SPSR"), SPDR("SPDR");
+hal_register TCCR1A("TCCR1A"), TCCR1B("TCCR1B"), TIMSK1("TIMSK1"), TIFR1("TIFR1");
+hal_register ADMUX("ADMUX"), ADCSRA("ADCSRA"), ADCSRB("ADCSRB"), ADCH("ADCH"), ADCL("ADCL");
+hal_register SREG("SREG");
+
+volatile uint16_t ICR1  = 0;
+volatile uint16_t TCNT1 = 0;
+
+hal_register_hook hal_on_register_write = NULL;
+void (*hal_on_plane_select)(uint8_t select) = NULL;
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+SPIClass SPI;
+
+bool hal_serial_echo = false;
+
+unsigned long hal_ticks = 0;
+uint16_t hal_analog[12];
+std::deque<uint16_t> hal_adc_samples;
+
+static unsigned long long cycles = 0;     // Simulated time
+static unsigned long long nextTick = 0;   // Time of the next Timer1 overflow
+static bool spiPending = false;
+static unsigned long long adcDone = 0;    // Time the conversion completes, 0 when none
+
+// CPU cycles per ADC clock
+
+static unsigned int adcPrescale(void) {
+  unsigned int divide = 1 << (ADCSRA.value & (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0)));
+  return(divide == 1  ?  2  :  divide);
+}
+
+hal_register &hal_register::operator=(uint8_t data) {
+  uint8_t before = value;
+
+  if (this == &TIFR1) {                   // Writing a one clears the flag
+    value &= ~data;
+  }
+  else if (this == &ADCSRA) {             // ... ADIF too
+    value = (data & ~_BV(ADIF)) | (before & ~data & _BV(ADIF));
+
+    if (! (value & _BV(ADEN))) {
+      value &= ~_BV(ADSC);
+      adcDone = 0;
+    }
+    else if ((value & _BV(ADSC))  &&  adcDone == 0) {
+      adcDone = cycles + 25UL * adcPrescale();
+    }
+  }
+  else {
+    value = data;
+  }
+
+  if (this == &SPDR) {                    // Transfer completes instantly
+    SPSR.value |= _BV(SPIF);
+    if ((SPCR.value & _BV(SPE))  &&  (SPCR.value & _BV(SPIE))) spiPending = true;
+  }
+
+  if (hal_on_register_write != NULL) hal_on_register_write(this, before, value);
+  return *this;
+}
+
+void hal_plane_select(uint8_t select) {
+  if (hal_on_plane_select != NULL) hal_on_plane_select(select);
+}
+
+void hal_reset(void) {
+  hal_register *registers[] = {
+    &PORTB, &PORTD, &PORTE, &SPCR, &SPSR, &SPDR,
+    &TCCR1A, &TCCR1B, &TIMSK1, &TIFR1, &SREG,
+    &ADMUX, &ADCSRA, &ADCSRB, &ADCH, &ADCL
+  };
+
+  for (size_t index = 0;  index < sizeof(registers) / sizeof(*registers);  index ++) {
+    registers[index]->value = 0;
+  }
+
+  ICR1 = TCNT1 = 0;
+  cycles = nextTick = 0;
+  hal_ticks = 0;
+  spiPending = false;
+  adcDone = 0;
+  hal_adc_samples.clear();
+  Serial.input.clear();
+  Serial.output.clear();
+  Serial1.input.clear();
+  Serial1.output.clear();
+}
+
+// Time and interrupts
+
+unsigned long long hal_cycles(void) {
+  return(cycles);
+}
+
+unsigned long hal_refresh_cycles(void) {
+  static const unsigned int prescale[] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+
+  unsigned int divide = prescale[TCCR1B.value & (_BV(CS12) | _BV(CS11) | _BV(CS10))];
+
+  if (divide == 0  ||  ICR1 == 0) return(0);
+  return(2UL * ICR1 * divide);            // Phase correct PWM counts up and down
+}
+
+void hal_service_interrupts(void) {
+  while (spiPending) {
+    spiPending = false;
+    if (SPI_STC_vect != NULL) SPI_STC_vect();
+  }
+}
+
+// The conversion completing now, see hal_adc_samples
+
+static void adcConvert(void) {
+  uint8_t channel = (ADMUX.value & 0x07)  |  ((ADCSRB.value & _BV(MUX5))  ?  8  :  0);
+  uint16_t sample = 0;
+
+  if (! hal_adc_samples.empty()) {
+    sample = hal_adc_samples.front();
+    hal_adc_samples.pop_front();
+  }
+  else {
+    for (uint8_t pin = 0;  pin < sizeof(hal_analog) / sizeof(*hal_analog);  pin ++) {
+      if (analogPinToChannel(pin) == channel) sample = hal_analog[pin];
+    }
+  }
+
+  sample &= 0x3ff;
+
+  if (ADMUX.value & _BV(ADLAR)) {
+    ADCH.value = sample >> 2;
+    ADCL.value = sample << 6;
+  }
+  else {
+    ADCH.value = sample >> 8;
+    ADCL.value = sample;
+  }
+
+  ADCSRA.value |= _BV(ADIF);
+
+  if ((ADCSRA.value & _BV(ADATE))  &&  (ADCSRB.value & (_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) == 0) {
+    adcDone += 13UL * adcPrescale();      // Free running
+  }
+  else {
+    ADCSRA.value &= ~_BV(ADSC);
+    adcDone = 0;
+  }
+
+  if ((ADCSRA.value & _BV(ADIE))  &&  ADC_vect != NULL) {
+    ADCSRA.value &= ~_BV(ADIF);           // Cleared by running the interrupt
+    ADC_vect();
+    hal_service_interrupts();
+  }
+}
+
+bool hal_adc_load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) return(false);
+
+  int sample;
+  while ((sample = fgetc(file)) != EOF) hal_adc_samples.push_back(sample << 2);
+
+  fclose(file);
+  return(true);
+}
+
+void hal_run(unsigned long long duration) {
+  unsigned long long end = cycles + duration;
+
+  while (true) {
+    unsigned long period = hal_refresh_cycles();
+    bool enabled = (TIMSK1.value & _BV(TOIE1))  &&  TIMER1_OVF_vect != NULL;
+
+    if (period == 0  ||  ! enabled) {
+      nextTick = 0;
+    }
+    else if (nextTick <= cycles) {
+      nextTick = cycles + period;
+    }
+
+    // An ADC conversion due first (or with no refresh interrupt to come)
+    if (adcDone != 0  &&  adcDone <= end  &&  (nextTick == 0  ||  adcDone < nextTick)) {
+      cycles = adcDone;
+      adcConvert();
+      continue;
+    }
+
+    if (nextTick == 0  ||  nextTick > end) break;
+
+    cycles = nextTick;
+    nextTick += period;
+    hal_ticks ++;
+    TIMER1_OVF_vect();
+    hal_service_interrupts();
+  }
+
+  cycles = end;
+}
+
+unsigned long micros(void) {
+  return(cycles / (F_CPU / 1000000L));
+}
+
+unsigned long millis(void) {
+  return(cycles / (F_CPU / 1000L));
+}
+
+void delay(unsigned long ms) {
+  unsigned long start = micros();
+
+  while (micros() - start < ms * 1000UL) {
+    yield();
+    hal_run(F_CPU / 1000000L * 10);       // 10 microseconds at a time
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  hal_run((unsigned long long) us * (F_CPU / 1000000L));
+}
+
+// Replaced by the Cube library's yield(), unless NO_CUBE_YIELD is defined
+__attribute__((weak)) void yield(void) {}
+
+// Leonardo digital pin to port bit, for the pins used by the Cube
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void) pin;
+  (void) mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  hal_register *port = NULL;
+  uint8_t bit = 0;
+
+  switch (pin) {
+    case 7:    port = &PORTE;  bit = 6;  break;
+    case 8:    port = &PORTB;  bit = 4;  break;
+    case 9:    port = &PORTB;  bit = 5;  break;
+    case 10:   port = &PORTB;  bit = 6;  break;
+    case 11:   port = &PORTB;  bit = 7;  break;
+    case 12:   port = &PORTD;  bit = 6;  break;
+    case SCK:  port = &PORTB;  bit = 1;  break;
+    case MOSI: port = &PORTB;  bit = 2;  break;
+    default:   return;
+  }
+
+  if (value == LOW) {
+    *port &= ~_BV(bit);
+  }
+  else {
+    *port |= _BV(bit);
+  }
+}
+
+int analogRead(uint8_t pin) {
+  if (pin >= A0) pin -= A0;
+  return(pin < sizeof(hal_analog) / sizeof(*hal_analog)  ?  hal_analog[pin]  :  0);
+}
+
+long random(long howBig) {
+  return(howBig <= 0  ?  0  :  rand() % howBig);
+}
+
+long random(long howSmall, long howBig) {
+  return(howSmall >= howBig  ?  howSmall  :  random(howBig - howSmall) + howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+  srand(seed);
+}
+
+// Print and Stream
+
+size_t Print::print(const __FlashStringHelper *string) {
+  return print(reinterpret_cast<const char *>(string));
+}
+
+size_t Print::print(const char *string) {
+  size_t count = 0;
+  while (*string) count += write(*string ++);
+  return count;
+}
+
+size_t Print::print(char character) {
+  return write(character);
+}
+
+size_t Print::print(int number) {
+  return print((long) number);
+}
+
+size_t Print::print(unsigned int number) {
+  return print((unsigned long) number);
+}
+
+size_t Print::print(long number) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "%ld", number);
+  return print(buffer);
+}
+
+size_t Print::print(unsigned long number) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), "%lu", number);
+  return print(buffer);
+}
+
+size_t Print::print(double number, int digits) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, number);
+  return print(buffer);
+}
+
+size_t Print::println(void) {
+  return write('\r') + write('\n');
+}
+
+int HardwareSerial::available(void) {
+  return input.size();
+}
+
+int HardwareSerial::read(void) {
+  if (input.empty()) return -1;
+  int character = input.front();
+  input.pop_front();
+  return character;
+}
+
+int HardwareSerial::peek(void) {
+  return input.empty()  ?  -1  :  input.front();
+}
+
+size_t HardwareSerial::write(uint8_t character) {
+  output += (char) character;
+  if (hal_serial_echo  &&  character != '\r') putchar(character);
+  return 1;
+}
+
+void hal_serial_input(Stream *port, const char *text) {
+  HardwareSerial *serial = static_cast<HardwareSerial *>(port);
+  while (*text) serial->input.push_back(*text ++);
+}
+
+std::string &hal_serial_output(Stream *port) {
+  return static_cast<HardwareSerial *>(port)->output;
+}
@@ -0,0 +1,100 @@
+/*
+ * File:    hal.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host (Linux) hardware abstraction layer, so that the Cube library can be
+ * compiled, tested, benchmarked and profiled on a workstation.
+ *
+ * Simulates the ATmega32U4 registers used by the library, the SPI bus, the
+ * serial ports, time, the Timer1 refresh interrupt and the ADC.  Nothing runs
+ * concurrently: time only passes, and interrupts only happen, when hal_run()
+ * or delay() is called.
+ */
+
+#ifndef HAL_h
+#define HAL_h
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+
+// 8 bit I/O register.  Every write is reported to hal_on_register_write, so
+// that the pin activity can be observed (see extras/test/my9262.h).
+
+class hal_register {
+  public:
+    explicit hal_register(const char *name) : name(name), value(0) {}
+
+    operator uint8_t() const { return value; }
+
+    hal_register &operator=(uint8_t data);
+    // int operands, as after the usual promotion of e.g. ~(1 << SPIE)
+    hal_register &operator|=(int data) { return *this = value | data; }
+    hal_register &operator&=(int data) { return *this = value & data; }
+
+    const char *name;
+    uint8_t     value;
+};
+
+typedef void (*hal_register_hook)(hal_register *reg, uint8_t before, uint8_t after);
+
+extern hal_register_hook hal_on_register_write;  // Called after each register write
+
+// Color plane select for cubes with more color planes than 74154 outputs
+// (see CUBE_EDGE in Cube.h), reported to hal_on_plane_select
+
+extern void hal_plane_select(uint8_t select);
+extern void (*hal_on_plane_select)(uint8_t select);
+
+#if defined(CUBE_EDGE)  &&  ! defined(CUBE_PLANE_SELECT)
+#if CUBE_EDGE * 3 > 16
+#define CUBE_PLANE_SELECT(select) hal_plane_select(select)
+#endif
+#endif
+
+// Serial port, characters are queued by hal_serial_input() and output is
+// collected in output (and optionally echoed to stdout).
+
+class Stream;
+
+extern void hal_serial_input(Stream *port, const char *text);
+extern std::string &hal_serial_output(Stream *port);
+extern bool hal_serial_echo;                      // Copy serial output to stdout
+
+// Time and interrupts
+
+extern void hal_reset(void);                      // Power on state, time zero
+
+extern unsigned long long hal_cycles(void);       // CPU cycles since hal_reset()
+extern unsigned long hal_refresh_cycles(void);    // Timer1 period, 0 when stopped
+extern unsigned long hal_ticks;                   // Timer1 overflow interrupts
+
+/* Advance time by the given number of CPU cycles, running each Timer1
+ * overflow interrupt (and any SPI interrupts it causes) as it falls due.
+ */
+extern void hal_run(unsigned long long cycles);
+
+/* Run interrupts made pending by register writes, e.g. SPI transfer complete.
+ */
+extern void hal_service_interrupts(void);
+
+extern uint16_t hal_analog[12];                   // analogRead() values
+
+/* ADC conversions, started through ADCSRA, complete after 13 (the first 25)
+ * ADC clocks, and run the ADC interrupt if it is enabled.  Only free running
+ * auto triggering is simulated.  Each conversion takes the next of the
+ * queued samples (10 bits), or once there are none the analog input's value
+ * from hal_analog.  The ADC interrupt runs as soon as each conversion is
+ * done, never held off by the refresh interrupt as on the AVR.
+ */
+extern std::deque<uint16_t> hal_adc_samples;
+
+/* Queues recorded samples from a file: raw unsigned 8 bit mono, e.g. from
+ * "sox recording.wav -r 9615 -c 1 -b 8 -e unsigned recording.raw".  False
+ * when the file can't be read.
+ */
+extern bool hal_adc_load(const char *path);
+
+#endif
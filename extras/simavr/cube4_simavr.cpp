@@ -0,0 +1,197 @@
+/*
+ * File:    cube4_simavr.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Runs scan_firmware.elf on a simulated ATmega32U4 (simavr), sends a script
+ * of serial commands at 115200 baud and then reports the refresh interrupt
+ * timing measured by the firmware (see CUBE_STATS in Cube.h).  At the default
+ * refresh period Timer1 counts CPU cycles, so these are cycle exact.
+ *
+ * Usage: cube4_simavr [-b budget cycles] [-r repeat] firmware.elf script
+ *
+ * Fails if the longest refresh interrupt exceeds the budget, or if any
+ * refresh interrupt overran.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/avr_uart.h>
+
+static const unsigned long FREQUENCY = 16000000;
+static const unsigned long CHARACTER_CYCLES = FREQUENCY / 11520;  // 115200 8N1
+
+static avr_t      *avr;
+static avr_irq_t  *uartInput;
+static bool        uartReady = true;
+static std::string received;
+
+static void uartOutput(struct avr_irq_t *irq, uint32_t value, void *param) {
+  received += (char) value;
+}
+
+static void uartXon(struct avr_irq_t *irq, uint32_t value, void *param) {
+  uartReady = true;
+}
+
+static void uartXoff(struct avr_irq_t *irq, uint32_t value, void *param) {
+  uartReady = false;
+}
+
+// Run for the given number of cycles, sending text at the serial line rate
+
+static bool run(
+  avr_cycle_count_t cycles,
+  const std::string &text = std::string()) {
+
+  avr_cycle_count_t end = avr->cycle + cycles;
+  avr_cycle_count_t next = avr->cycle;
+  size_t sent = 0;
+
+  while (avr->cycle < end  ||  sent < text.size()) {
+    if (sent < text.size()  &&  uartReady  &&  avr->cycle >= next) {
+      avr_raise_irq(uartInput, (uint8_t) text[sent ++]);
+      next = avr->cycle + CHARACTER_CYCLES;
+    }
+
+    int state = avr_run(avr);
+    if (state == cpu_Done  ||  state == cpu_Crashed) {
+      fprintf(stderr, "Firmware stopped (state %d)\n", state);
+      return(false);
+    }
+  }
+
+  return(true);
+}
+
+static bool runUntil(
+  const char *expected,
+  avr_cycle_count_t timeout) {
+
+  avr_cycle_count_t end = avr->cycle + timeout;
+
+  while (received.find(expected) == std::string::npos) {
+    if (avr->cycle >= end  ||  ! run(FREQUENCY / 1000)) return(false);
+  }
+
+  return(true);
+}
+
+static bool statistic(
+  const char *label,
+  const char *format,
+  unsigned long *value1,
+  unsigned long *value2 = NULL,
+  unsigned long *value3 = NULL) {
+
+  size_t position = received.rfind(label);
+  if (position == std::string::npos) return(false);
+
+  int count = sscanf(received.c_str() + position + strlen(label), format, value1, value2, value3);
+  return(count == 1 + (value2 != NULL) + (value3 != NULL));
+}
+
+int main(int argc, char *argv[]) {
+  unsigned long budget = 2400;
+  unsigned long repeat = 4;
+  int option;
+
+  while ((option = getopt(argc, argv, "b:r:")) != -1) {
+    switch (option) {
+      case 'b': budget = strtoul(optarg, NULL, 0);  break;
+      case 'r': repeat = strtoul(optarg, NULL, 0);  break;
+      default:  optind = argc;                      break;
+    }
+  }
+
+  if (argc - optind != 2) {
+    fprintf(stderr, "Usage: %s [-b budget cycles] [-r repeat] firmware.elf script\n", argv[0]);
+    return(2);
+  }
+
+  std::string script;
+  FILE *file = fopen(argv[optind + 1], "r");
+  if (file == NULL) {
+    perror(argv[optind + 1]);
+    return(2);
+  }
+  int character;
+  while ((character = fgetc(file)) != EOF) {
+    if (character != '\n'  &&  character != '\r') script += (char) character;
+  }
+  fclose(file);
+
+  elf_firmware_t firmware;
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(argv[optind], &firmware) != 0) {
+    fprintf(stderr, "Couldn't read %s\n", argv[optind]);
+    return(2);
+  }
+
+  avr = avr_make_mcu_by_name("atmega32u4");
+  if (avr == NULL) {
+    fprintf(stderr, "simavr doesn't support the atmega32u4\n");
+    return(2);
+  }
+  avr_init(avr);
+  avr->frequency = FREQUENCY;
+  avr_load_firmware(avr, &firmware);
+
+  uint32_t flags = 0;                        // Don't echo the UART to stdout
+  avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('1'), &flags);
+  flags &= ~AVR_UART_FLAG_STDIO;
+  avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('1'), &flags);
+
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_OUTPUT),   uartOutput, NULL);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_OUT_XON),  uartXon,    NULL);
+  avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_OUT_XOFF), uartXoff,   NULL);
+  uartInput = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_INPUT);
+
+  if (! runUntil("Type 'help;'", FREQUENCY)) {
+    fprintf(stderr, "No start up message from the firmware\n");
+    return(1);
+  }
+
+  run(FREQUENCY / 100, "resetstats;");
+  for (unsigned long count = 0;  count < repeat;  count ++) run(0, script);
+  run(FREQUENCY / 20);                       // Let the last commands execute
+
+  received.clear();
+  run(0, "stats;");
+  if (! runUntil("loops/s:", FREQUENCY)) {
+    fprintf(stderr, "No stats from the firmware\n");
+    return(1);
+  }
+
+  unsigned long isrMin, isrAverage, isrMax, scanMax, serialAverage, serialMax, overruns;
+
+  if (! statistic("isr ticks min/avg/max: ", "%lu/%lu/%lu", &isrMin, &isrAverage, &isrMax)  ||
+      ! statistic("scan ticks max: ", "%lu", &scanMax)  ||
+      ! statistic("serial ticks avg/max: ", "%lu/%lu", &serialAverage, &serialMax)  ||
+      ! statistic("overruns: ", "%lu", &overruns)) {
+
+    fprintf(stderr, "Couldn't parse the stats:\n%s\n", received.c_str());
+    return(1);
+  }
+
+  printf("isr cycles min/avg/max: %lu/%lu/%lu\n", isrMin, isrAverage, isrMax);
+  printf("scan cycles max: %lu\n", scanMax);
+  printf("serial cycles avg/max: %lu/%lu\n", serialAverage, serialMax);
+  printf("overruns: %lu\n", overruns);
+  printf("budget: %lu cycles\n", budget);
+
+  if (isrMax > budget  ||  overruns > 0) {
+    printf("FAIL\n");
+    return(1);
+  }
+
+  printf("PASS\n");
+  return(0);
+}
@@ -0,0 +1,21 @@
+/*
+ * File:    scan_firmware.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Firmware run by cube4_simavr: the Cube library built with CUBE_STATS,
+ * controlled via Serial1 (simavr doesn't emulate the USB serial port).
+ * Replaces the Arduino core's main(), so that USB is never attached.
+ */
+
+#include "Cube.h"
+
+Cube cube;
+
+int main(void) {
+  init();
+  cube.begin(1, 115200);
+
+  while (true) cube.poll();
+}
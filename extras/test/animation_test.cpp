@@ -0,0 +1,199 @@
+/*
+ * File:    animation_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Encodes frames drawn by the library (extras/host/animation_encode.h),
+ * plays them back with Cube::play(), and checks that each frame is decoded
+ * exactly, when it is due.
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include "Cube.h"
+#include "check.h"
+#include "animation_encode.h"
+
+static const unsigned long LOOP_CYCLES = F_CPU / 10000;  // Poll every 0.1 ms
+
+Cube cube;
+
+static bool sameFrame(
+  const animation_frame_t &a,
+  const animation_frame_t &b) {
+
+  for (unsigned int index = 0;  index < ANIMATION_VOXELS;  index ++) {
+    if (! animationSame(a[index], b[index])) return(false);
+  }
+
+  return(true);
+}
+
+static bool showing(
+  frame_t                 *frame,
+  const animation_frame_t &expected) {
+
+  return(sameFrame(animationCapture(frame), expected));
+}
+
+// Frames with a mix of small changes, big changes and repeats
+
+static std::vector<animation_source_t> drawFrames(
+  unsigned int count) {
+
+  const byte L = CUBE_SIZE - 1;
+  rgb_t colors[] = { RED, GREEN, BLUE, WHITE, ORANGE, RGB(0x01, 0x02, 0x03) };
+  std::vector<animation_source_t> frames;
+
+  cube.all(BLACK);
+
+  for (unsigned int index = 0;  index < count;  index ++) {
+    rgb_t rgb = colors[random(6)];
+
+    switch (random(6)) {
+      case 0:  cube.set(random(CUBE_SIZE), random(CUBE_SIZE), random(CUBE_SIZE), rgb);  break;
+      case 1:  cube.shift(random(3), '+');                                               break;
+      case 2:  cube.line(0, random(CUBE_SIZE), 0, L, random(CUBE_SIZE), L, rgb);        break;
+      case 3:  cube.sphere(1, 1, 1, 3, rgb);                                             break;
+      case 4:
+        for (byte voxel = 0;  voxel < 20;  voxel ++) {
+          cube.set(random(CUBE_SIZE), random(CUBE_SIZE), random(CUBE_SIZE), colors[random(6)]);
+        }
+        break;
+      default: break;                                                                     // Repeat
+    }
+
+    animation_source_t frame = { animationCapture(led), (unsigned int) (1 + random(40)) };
+    frames.push_back(frame);
+  }
+
+  return(frames);
+}
+
+// Polls until the animation stops, checking that each frame is in the
+// drawing buffer from its due time until the next frame is due
+
+static void checkPlayback(
+  const char                            *name,
+  const std::vector<animation_source_t> &frames,
+  const std::vector<byte>               &data,
+  byte                                   loops) {
+
+  unsigned int mismatches = 0;
+  unsigned long start = millis();
+  check(cube.play(& data[0], loops), name);
+
+  unsigned long due   = start;
+  unsigned int  index = 0;
+  unsigned int  later = 0;                        // Frames decoded after the first
+
+  while (cube.isPlaying()) {
+    cube.poll();
+    unsigned long now = millis();
+
+    if ((long) (now - (due + frames[index].duration)) >= 0) {
+      due += frames[index].duration;              // poll() decoded the next frame
+      index = (index + 1) % frames.size();
+      later ++;
+    }
+
+    if (! showing(led, frames[index].voxels)  &&  mismatches ++ < 4) {
+      printf("%s: frame %u differs at %lu ms\n", name, index, now - start);
+    }
+
+    hal_run(LOOP_CYCLES);
+  }
+
+  check(mismatches == 0, name);
+  check(later + 1 == frames.size() * loops, "every frame decoded");
+  check(showing(led, frames.back().voxels), "last frame stays");
+}
+
+#ifndef NO_DOUBLE_BUFFER
+// Double buffered, the displayed frames must be whole frames, in order, and
+// none may be dropped (unless it is the same as one either side)
+
+static void checkDoubleBuffered(
+  const std::vector<animation_source_t> &frames,
+  const std::vector<byte>               &data) {
+
+  unsigned int mismatches = 0;
+  unsigned int latest = 0;
+  bool started = false;
+
+  cube.doubleBuffer(true);
+  check(cube.play(& data[0], 1), "double buffered play");
+
+  for (unsigned long end = millis() + 10;  cube.isPlaying()  ||  (long) (millis() - end) < 0;  ) {
+    if (cube.isPlaying()) end = millis() + 10;    // Then time for the last swap
+
+    cube.poll();
+    hal_run(LOOP_CYCLES);
+
+    // Until the first swap, the last test's frame is still displayed
+    unsigned int last  = started  ?  frames.size()  :  1;
+    unsigned int index = latest;
+    while (index < last  &&  ! showing(ledDisplay, frames[index].voxels)) index ++;
+
+    if (index < last) {
+      for (unsigned int skipped = latest + 1;  skipped < index;  skipped ++) {
+        if (! sameFrame(frames[skipped].voxels, frames[latest].voxels)  &&
+            ! sameFrame(frames[skipped].voxels, frames[index].voxels)  &&  mismatches ++ < 4) {
+          printf("double buffered: frame %u never displayed\n", skipped);
+        }
+      }
+
+      latest  = index;
+      started = true;
+    }
+    else if (started  &&  mismatches ++ < 4) {
+      printf("double buffered: displayed frame isn't frame %u or later\n", latest);
+    }
+  }
+
+  check(started  &&  mismatches == 0, "double buffered frames whole, in order and all displayed");
+  check(latest == frames.size() - 1, "double buffered last frame displayed");
+  check(showing(led, frames.back().voxels), "double buffered last frame drawn on");
+
+  cube.suspend();                  // Nothing interrupts waitForShow() on the host
+  cube.doubleBuffer(false);
+  cube.resume();
+}
+#endif
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+  srand(1);
+
+  std::vector<animation_source_t> frames = drawFrames(200);
+  std::vector<byte> data = animationEncode(frames);
+  unsigned long raw = frames.size() * ANIMATION_VOXELS * sizeof(rgb_t);
+
+  printf("%zu frames: %zu bytes, %lu uncompressed\n", frames.size(), data.size(), raw);
+  check(data.size() < raw / 4, "compressed");
+
+  checkPlayback("playback", frames, data, 2);
+
+  // With a keyframe every 10 frames
+  std::vector<byte> keyframed = animationEncode(frames, 10);
+  check(keyframed.size() > data.size(), "keyframes");
+  checkPlayback("keyframed playback", frames, keyframed, 1);
+
+#ifndef NO_DOUBLE_BUFFER
+  checkDoubleBuffered(frames, data);
+#endif
+
+  // Stopping, and animations for other cubes
+  check(cube.play(& data[0]), "play forever");
+  cube.stop();
+  check(! cube.isPlaying(), "stop");
+
+  std::vector<byte> other = data;
+  other[ANIMATION_EDGE] = CUBE_SIZE + 4;
+  check(! cube.play(& other[0])  &&  ! cube.isPlaying(), "other cube size");
+
+  return(checkPassed());
+}
@@ -0,0 +1,39 @@
+/*
+ * File:    check.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Shared by the host tests: check() reports and counts each failure, same()
+ * compares two colors, and checkPassed() prints PASS when nothing failed and
+ * returns main()'s exit status.  Include after Cube.h.
+ */
+
+#ifndef CHECK_h
+#define CHECK_h
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static inline void check(
+  bool        condition,
+  const char *message) {
+
+  if (! condition) {
+    printf("FAIL: %s\n", message);
+    failures ++;
+  }
+}
+
+static inline bool same(rgb_t a, rgb_t b) {
+  return(memcmp(& a, & b, sizeof(rgb_t)) == 0);
+}
+
+static inline int checkPassed(void) {
+  if (failures == 0) printf("PASS\n");
+  return(failures == 0  ?  0  :  1);
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * File:    fade_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks fades (see engine.cpp): the colour at each tick against the fixed
+ * point model, the region they cover, the slots, replacing and stopping
+ * them, and that each step is displayed when double buffering.
+ */
+
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+
+static const unsigned long TICK_CYCLES = F_CPU / 1000;   // Poll every 1 ms
+
+Cube cube;
+
+static void tick(void) {
+  hal_run(TICK_CYCLES);
+  cube.poll();
+}
+
+static rgb_t expected(
+  rgb_t         from,
+  rgb_t         to,
+  unsigned long elapsed,
+  unsigned int  period) {
+
+  unsigned int step = (elapsed < period)  ?  (elapsed * 256) / period  :  256;
+  rgb_t rgb;
+
+  for (byte color = 0;  color < 3;  color ++) {
+    rgb.color[color] = (from.color[color] * (256 - step) + to.color[color] * step) / 256;
+  }
+
+  return(rgb);
+}
+
+// A serial fade of part of the cube, checked at every tick
+
+static void checkSerialFade(void) {
+  const rgb_t from = RGB(0x00, 0x00, 0x00);
+  const rgb_t to   = RGB(0xff, 0x80, 0x10);
+  unsigned int mismatches = 0;
+
+  cube.all(GREEN);
+
+  char fade[] = "fade 110 000 000000 ff8010 1000";
+  bytecode_t bytecode = {};
+  check(parser(fade, strlen(fade), & bytecode) == 0, "fade command");
+  check(cube.isFading(), "fading");
+
+  unsigned long start = millis();
+  unsigned int  last  = 0;
+
+  while (millis() - start < 1100) {
+    tick();
+    unsigned long elapsed = millis() - start;
+    rgb_t rgb = frameGet(led, 1, 1, 0);
+
+    if (! same(rgb, expected(from, to, elapsed, 1000))  &&  mismatches ++ < 4) {
+      printf("fade: %02x%02x%02x at %lu ms\n", rgb.color[0], rgb.color[1], rgb.color[2], elapsed);
+    }
+
+    if (rgb.color[0] < last) mismatches ++;
+    last = rgb.color[0];
+  }
+
+  check(mismatches == 0, "fade colours each tick");
+  check(! cube.isFading(), "fade ends");
+  check(same(frameGet(led, 0, 0, 0), to)  &&  same(frameGet(led, 1, 1, 0), to), "fade region");
+  check(same(frameGet(led, 2, 1, 0), GREEN)  &&  same(frameGet(led, 1, 1, 1), GREEN), "outside the region");
+
+  // Missing fields
+  char partial[] = "fade 000 333 red blue";
+  check(parser(partial, strlen(partial), & bytecode) != 0  &&  ! cube.isFading(), "fade needs a period");
+}
+
+static void checkSlots(void) {
+  cube.all(BLACK);
+
+  // One more single voxel fade than there are slots
+  for (byte slot = 0;  slot <= FADE_SLOTS;  slot ++) {
+    cube.fade(slot % CUBE_SIZE, slot / CUBE_SIZE, 0, slot % CUBE_SIZE, slot / CUBE_SIZE, 0, BLACK, WHITE, 100);
+    tick();
+  }
+
+  check(same(frameGet(led, 0, 0, 0), WHITE), "oldest fade finished early");
+  check(! same(frameGet(led, 1, 0, 0), WHITE)  &&  ! same(frameGet(led, 1, 0, 0), BLACK), "others still fading");
+
+  // The same region, given the other way around, replaces its fade
+  cube.fade(1, 0, 0, 1, 0, 0, RED, RED, 1000);
+  tick();
+  check(same(frameGet(led, 1, 0, 0), RED), "fade replaced");
+  check(! same(frameGet(led, 2, 0, 0), WHITE), "other fades kept");
+
+  cube.fadeStop();
+  check(! cube.isFading(), "stop");
+  rgb_t stopped = frameGet(led, 2, 0, 0);
+  for (byte count = 0;  count < 10;  count ++) tick();
+  check(same(frameGet(led, 2, 0, 0), stopped), "stopped fades stay");
+
+  // No time at all
+  cube.fade(BLUE, YELLOW, 0);
+  tick();
+  check(! cube.isFading()  &&  same(frameGet(led, 3, 3, 3), YELLOW), "zero period");
+}
+
+#ifndef NO_DOUBLE_BUFFER
+// Double buffered, each step is shown, and the last one stays
+
+static void checkDoubleBuffered(void) {
+  unsigned int steps = 0;
+  rgb_t last = BLACK;
+
+  cube.all(BLACK);
+  cube.doubleBuffer(true);
+  cube.fade(BLACK, BLUE, 200);
+
+  while (cube.isFading()) {
+    tick();
+
+    rgb_t rgb = frameGet(ledDisplay, 2, 2, 2);
+    if (! same(rgb, last)) steps ++;
+    last = rgb;
+  }
+
+  for (byte count = 0;  count < 10;  count ++) tick();
+
+  check(steps > 20, "double buffered steps displayed");
+  check(same(frameGet(ledDisplay, 0, 0, 0), BLUE)  &&  same(frameGet(led, 0, 0, 0), BLUE), "double buffered end");
+
+  cube.suspend();                  // Nothing interrupts waitForShow() on the host
+  cube.doubleBuffer(false);
+  cube.resume();
+}
+
+// Double buffered, a running fade owns the back buffer: drawing there after a
+// step has been displayed is replaced when poll() copies it back, but once
+// the fade has finished, drawing after waitForShow() is kept
+
+static void checkBackBufferOwner(void) {
+  cube.all(BLACK);
+  cube.doubleBuffer(true);
+  cube.fade(0, 0, 0, 1, 1, 1, BLACK, BLUE, 100);
+
+  while (! cube.isShowPending()) tick();
+  while (cube.isShowPending()) hal_run(TICK_CYCLES);
+  cube.set(3, 3, 3, WHITE);
+  tick();
+  check(same(frameGet(led, 3, 3, 3), BLACK), "drawing while fading is replaced");
+
+  while (cube.isFading()) tick();
+  cube.suspend();
+  cube.waitForShow();
+  cube.resume();
+
+  cube.set(3, 3, 3, WHITE);
+  cube.show();
+  for (byte count = 0;  count < 20;  count ++) tick();
+  check(same(frameGet(ledDisplay, 3, 3, 3), WHITE), "drawing after the fade is kept");
+  check(same(frameGet(ledDisplay, 1, 1, 1), BLUE), "fade kept");
+
+  cube.suspend();
+  cube.doubleBuffer(false);
+  cube.resume();
+}
+#endif
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+
+  checkSerialFade();
+  checkSlots();
+#ifndef NO_DOUBLE_BUFFER
+  checkDoubleBuffered();
+  checkBackBufferOwner();
+#endif
+
+  return(checkPassed());
+}
@@ -0,0 +1,524 @@
+/*
+ * File:    graphics_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks the voxels drawn by the graphics primitives.
+ */
+
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+
+extern byte cursorX, cursorY, cursorZ;           // graphics.h
+
+Cube cube;
+
+static bool lit(
+  byte x,
+  byte y,
+  byte z) {
+
+  rgb_t rgb = frameGet(led, x, y, z);
+  return(rgb.color[0] | rgb.color[1] | rgb.color[2]);
+}
+
+// Lit voxels must be exactly those for which expected() is true
+
+static void checkVoxels(
+  const char *name,
+  bool (*expected)(byte x, byte y, byte z)) {
+
+  byte mismatches = 0;
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+        if (lit(x, y, z) != expected(x, y, z)  &&  mismatches ++ < 4) {
+          printf("%s: voxel %d %d %d is %s\n", name, x, y, z, lit(x, y, z)  ?  "lit"  :  "not lit");
+        }
+      }
+    }
+  }
+
+  check(mismatches == 0, name);
+}
+
+/* The original floating point cubeLine(), which the integer version must
+ * match voxel for voxel.
+ */
+
+static bool referenceVoxels[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+static void referenceSwap(byte &a, byte &b) {
+  byte c = a;
+  a = b;
+  b = c;
+}
+
+static void referenceLine(
+  byte x1, byte y1, byte z1, byte x2, byte y2, byte z2) {
+
+  boolean swap_xy = abs(y2 - y1) > abs(x2 - x1);
+  if (swap_xy) {
+    referenceSwap(x1, y1);
+    referenceSwap(x2, y2);
+  }
+
+  boolean swap_xz = abs(z2 - z1) > abs(x2 - x1);
+  if (swap_xz) {
+    referenceSwap(x1, z1);
+    referenceSwap(x2, z2);
+  }
+
+  byte delta_x = abs(x2 - x1);
+  byte delta_y = abs(y2 - y1);
+  byte delta_z = abs(z2 - z1);
+  float drift_xy = (delta_x / 2);
+  float drift_xz = (delta_x / 2);
+  byte step_x = (x1 > x2)  ?  -1  :  1;
+  byte step_y = (y1 > y2)  ?  -1  :  1;
+  byte step_z = (z1 > z2)  ?  -1  :  1;
+  byte y = y1;
+  byte z = z1;
+
+  for (byte x = x1;  x != (byte) (x2 + step_x);  x += step_x) {
+    byte cx = x, cy = y, cz = z;
+    if (swap_xz) referenceSwap(cx, cz);
+    if (swap_xy) referenceSwap(cx, cy);
+    referenceVoxels[cx][cy][cz] = true;
+
+    drift_xy = drift_xy - delta_y;
+    drift_xz = drift_xz - delta_z;
+    if (drift_xy < 0) {
+      y = y + step_y;
+      drift_xy = drift_xy + delta_x;
+    }
+    if (drift_xz < 0) {
+      z = z + step_z;
+      drift_xz = drift_xz + delta_x;
+    }
+  }
+}
+
+static void checkLines(void) {
+  unsigned int mismatches = 0;
+  const byte S = CUBE_SIZE;
+
+  for (unsigned int from = 0;  from < S * S * S;  from ++) {
+    for (unsigned int to = 0;  to < S * S * S;  to ++) {
+      byte x1 = from % S, y1 = from / S % S, z1 = from / S / S;
+      byte x2 = to % S,   y2 = to / S % S,   z2 = to / S / S;
+
+      cube.all(BLACK);
+      memset(referenceVoxels, 0, sizeof(referenceVoxels));
+      cube.line(x1, y1, z1, x2, y2, z2, WHITE);
+      referenceLine(x1, y1, z1, x2, y2, z2);
+
+      for (unsigned int index = 0;  index < S * S * S;  index ++) {
+        byte x = index % S, y = index / S % S, z = index / S / S;
+        if (lit(x, y, z) != referenceVoxels[x][y][z]) {
+          if (mismatches ++ < 4) printf("line %d%d%d %d%d%d differs at %d%d%d\n", x1, y1, z1, x2, y2, z2, x, y, z);
+        }
+      }
+
+      if (cursorX != x2  ||  cursorY != y2  ||  cursorZ != z2) mismatches ++;
+    }
+  }
+
+  check(mismatches == 0, "lines match the original cubeLine()");
+}
+
+// The bulk operations against a voxel by voxel model
+
+static rgb_t model[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+static void modelPoint(byte axis, byte position, byte i, byte j, byte *x, byte *y, byte *z) {
+  *x = (axis == X)  ?  position  :  i;
+  *y = (axis == Y)  ?  position  :  (axis == X  ?  i  :  j);
+  *z = (axis == Z)  ?  position  :  j;
+}
+
+static void modelSetplane(byte axis, byte position, rgb_t rgb) {
+  byte x, y, z;
+  for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+    for (byte j = 0;  j < CUBE_SIZE;  j ++) {
+      modelPoint(axis, position, i, j, & x, & y, & z);
+      model[x][y][z] = rgb;
+    }
+  }
+}
+
+static void modelCopyplane(byte axis, byte position, byte destination) {
+  byte x, y, z, x2, y2, z2;
+  for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+    for (byte j = 0;  j < CUBE_SIZE;  j ++) {
+      modelPoint(axis, position, i, j, & x, & y, & z);
+      modelPoint(axis, destination, i, j, & x2, & y2, & z2);
+      model[x2][y2][z2] = model[x][y][z];
+    }
+  }
+}
+
+static void modelSetAll(rgb_t rgb) {
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) modelSetplane(Z, z, rgb);
+}
+
+static bool modelDiffers(void) {
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        rgb_t rgb = frameGet(led, x, y, z);
+        if (memcmp(& rgb, & model[x][y][z], sizeof(rgb)) != 0) return(true);
+      }
+    }
+  }
+
+  return(false);
+}
+
+static void checkBulk(void) {
+  const byte L = CUBE_SIZE - 1;
+  unsigned int mismatches = 0;
+
+  for (unsigned int step = 0;  step < 2000;  step ++) {
+    byte axis = random(3);
+    byte a = random(CUBE_SIZE);
+    byte b = random(CUBE_SIZE);
+    rgb_t rgb = RGB((byte) random(256), (byte) random(256), (byte) random(256));
+
+    switch (random(6)) {
+      case 0:
+        cube.set(a, b, random(CUBE_SIZE), rgb);
+        model[a][b][cursorZ] = rgb;
+        break;
+
+      case 1:
+        cube.setplane(axis, a, rgb);
+        modelSetplane(axis, a, rgb);
+        break;
+
+      case 2:
+        cube.copyplane(axis, a, b);
+        modelCopyplane(axis, a, b);
+        if (cursorX != (axis == X  ?  b  :  L)  ||
+            cursorY != (axis == Y  ?  b  :  L)  ||
+            cursorZ != (axis == Z  ?  b  :  L)) mismatches ++;
+        break;
+
+      case 3:
+        cube.moveplane(axis, a, b, rgb);
+        modelCopyplane(axis, a, b);
+        modelSetplane(axis, a, rgb);
+        break;
+
+      case 4:
+        if (b & 1) {
+          cube.shift(axis, '+');
+          for (byte i = L;  i > 0;  i --) modelCopyplane(axis, i - 1, i);
+          modelSetplane(axis, 0, BLACK);
+        }
+        else {
+          cube.shift(axis, '-');
+          for (byte i = 0;  i < L;  i ++) modelCopyplane(axis, i + 1, i);
+          modelSetplane(axis, L, BLACK);
+        }
+        break;
+
+      case 5:
+        if (a == 0) {
+          cube.all(rgb);
+          modelSetAll(rgb);
+        }
+        break;
+    }
+
+    if (modelDiffers()  &&  mismatches ++ < 4) printf("bulk step %u differs\n", step);
+  }
+
+  check(mismatches == 0, "bulk operations match voxel by voxel model");
+}
+
+// Spheres against the original nested boxes, and ellipsoids against the
+// exact integer inclusion test
+
+static void modelBox(byte x1, byte y1, byte z1, byte x2, byte y2, byte z2, rgb_t rgb, bool edges, rgb_t fill) {
+  for (byte x = x1;  x <= x2;  x ++) {
+    for (byte y = y1;  y <= y2;  y ++) {
+      for (byte z = z1;  z <= z2;  z ++) {
+        byte extremes = (x == x1  ||  x == x2) + (y == y1  ||  y == y2) + (z == z1  ||  z == z2);
+        model[x][y][z] = (edges  &&  extremes < 2)  ?  fill  :  rgb;
+      }
+    }
+  }
+}
+
+static void modelOriginalSphere(byte x1, byte y1, byte z1, byte size, rgb_t rgb, rgb_t fill) {
+  if (size <= 2) {
+    modelBox(x1, y1, z1, x1 + size - 1, y1 + size - 1, z1 + size - 1, rgb, false, BLACK);
+  }
+  else {
+    byte add = size - 2;
+    modelBox(x1 - 1, y1 - 1, z1 - 1, x1 + add, y1 + add, z1 + add, BLACK, true, rgb);
+    modelBox(x1, y1, z1, x1 + add - 1, y1 + add - 1, z1 + add - 1, fill, false, BLACK);
+  }
+}
+
+static bool ellipsoidInside(int x, int y, int z, const int *centre2, const long long *limit) {
+  long long d[3] = { 2 * x - centre2[X], 2 * y - centre2[Y], 2 * z - centre2[Z] };
+
+  return(d[X] * d[X] * limit[Y] * limit[Z] + d[Y] * d[Y] * limit[X] * limit[Z] +
+         d[Z] * d[Z] * limit[X] * limit[Y] <= limit[X] * limit[Y] * limit[Z]);
+}
+
+static void modelEllipsoid(const byte *centre, const byte *size, rgb_t rgb, byte style, rgb_t fill) {
+  int       centre2[3];
+  long long limit[3];
+
+  for (byte axis = X;  axis <= Z;  axis ++) {
+    centre2[axis] = 2 * centre[axis] + (size[axis] % 2 == 0);
+    limit[axis]   = (long long) size[axis] * size[axis] - size[axis] + 1;
+  }
+
+  for (int x = 0;  x < CUBE_SIZE;  x ++) {
+    for (int y = 0;  y < CUBE_SIZE;  y ++) {
+      for (int z = 0;  z < CUBE_SIZE;  z ++) {
+        if (! ellipsoidInside(x, y, z, centre2, limit)) continue;
+
+        bool shell =
+          ! ellipsoidInside(x - 1, y, z, centre2, limit)  ||  ! ellipsoidInside(x + 1, y, z, centre2, limit)  ||
+          ! ellipsoidInside(x, y - 1, z, centre2, limit)  ||  ! ellipsoidInside(x, y + 1, z, centre2, limit)  ||
+          ! ellipsoidInside(x, y, z - 1, centre2, limit)  ||  ! ellipsoidInside(x, y, z + 1, centre2, limit);
+
+        if (shell  ||  style == 0) {
+          model[x][y][z] = rgb;
+        }
+        else if (style == 3) {
+          model[x][y][z] = fill;
+        }
+      }
+    }
+  }
+}
+
+static void checkEllipsoids(void) {
+  static const byte styles[] = { 0, 1, 3 };
+  unsigned int mismatches = 0;
+
+  for (byte size = 1;  size <= 4;  size ++) {
+    byte first = (size <= 2)  ?  0  :  1;
+    byte last  = CUBE_SIZE - size + first;
+
+    for (byte centre = first;  centre <= last;  centre ++) {
+      cube.all(WHITE);
+      modelSetAll(WHITE);
+      cube.sphere(centre, centre, last - centre + first, size, RED, BLUE);
+      modelOriginalSphere(centre, centre, last - centre + first, size, RED, BLUE);
+      if (modelDiffers()  &&  mismatches ++ < 4) printf("sphere %d at %d differs from the original\n", size, centre);
+    }
+  }
+
+  check(mismatches == 0, "spheres match the original 4x4x4 spheres");
+
+  mismatches = 0;
+
+  for (unsigned int step = 0;  step < 3000;  step ++) {
+    byte  centre[3];
+    byte  size[3];
+    byte  style = styles[random(3)];
+    rgb_t background = RGB((byte) random(256), 0, 0);
+
+    for (byte axis = X;  axis <= Z;  axis ++) {
+      centre[axis] = random(CUBE_SIZE + 3);
+      size[axis]   = 1 + random((step & 1)  ?  2 * CUBE_SIZE + 3  :  9);
+    }
+    if (step & 1) size[Y] = size[Z] = size[X];           // Spheres
+
+    cube.all(background);
+    modelSetAll(background);
+    cube.ellipsoid(centre[X], centre[Y], centre[Z], size[X], size[Y], size[Z], GREEN, style, BLUE);
+    modelEllipsoid(centre, size, GREEN, style, BLUE);
+
+    if (modelDiffers()  &&  mismatches ++ < 4) {
+      printf("ellipsoid %d%d%d size %d %d %d style %d differs\n",
+        centre[X], centre[Y], centre[Z], size[X], size[Y], size[Z], style);
+    }
+  }
+
+  check(mismatches == 0, "ellipsoids match the integer inclusion test");
+
+  // Bounded for any size: a huge sphere covers the whole cube
+  cube.all(BLACK);
+  cube.sphere(1, 1, 1, 255, RED, BLUE);
+  check(lit(0, 0, 0)  &&  lit(CUBE_SIZE - 1, CUBE_SIZE - 1, CUBE_SIZE - 1), "huge sphere");
+
+  // Over serial, only drawn when it parses
+  bytecode_t bytecode = {};
+
+  char good[] = "ellipsoid 111 333 red";
+  cube.all(BLACK);
+  check(parser(good, strlen(good), & bytecode) == 0  &&  lit(1, 1, 1), "serial ellipsoid");
+
+  char badSize[] = "ellipsoid 111 3x3 red";
+  cube.all(BLACK);
+  check(parser(badSize, strlen(badSize), & bytecode) != 0  &&  ! lit(1, 1, 1), "serial ellipsoid size expected");
+
+  char badColor[] = "ellipsoid 111 333 nocolor";
+  cube.all(BLACK);
+  check(parser(badColor, strlen(badColor), & bytecode) != 0  &&  ! lit(1, 1, 1), "serial ellipsoid colour expected");
+}
+
+// Transforms against the model, moved one voxel at a time
+
+static void modelQuarterTurn(byte axis) {
+  const byte L = CUBE_SIZE - 1;
+  static rgb_t turned[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        if (axis == X) turned[x][L - z][y] = model[x][y][z];
+        if (axis == Y) turned[z][y][L - x] = model[x][y][z];
+        if (axis == Z) turned[L - y][x][z] = model[x][y][z];
+      }
+    }
+  }
+
+  memcpy(model, turned, sizeof(model));
+}
+
+static void modelMirror(byte axis) {
+  const byte L = CUBE_SIZE - 1;
+  static rgb_t mirrored[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        mirrored[axis == X  ?  L - x  :  x][axis == Y  ?  L - y  :  y][axis == Z  ?  L - z  :  z] = model[x][y][z];
+      }
+    }
+  }
+
+  memcpy(model, mirrored, sizeof(model));
+}
+
+static void modelTranspose(byte axis1, byte axis2) {
+  static rgb_t transposed[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        byte to[3] = { x, y, z };
+        byte swap = to[axis1];
+        to[axis1] = to[axis2];
+        to[axis2] = swap;
+        transposed[to[X]][to[Y]][to[Z]] = model[x][y][z];
+      }
+    }
+  }
+
+  memcpy(model, transposed, sizeof(model));
+}
+
+static void checkTransforms(void) {
+  unsigned int mismatches = 0;
+
+  // Every voxel a different colour
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        model[x][y][z] = RGB(x, y, z);
+        cube.set(x, y, z, model[x][y][z]);
+      }
+    }
+  }
+
+  for (unsigned int step = 0;  step < 300;  step ++) {
+    byte axis = random(3);
+    byte operation = random(3);
+
+    if (operation == 0) {
+      byte quarters = random(5);
+      cube.rotate(axis, quarters);
+      for (byte quarter = 0;  quarter < quarters % 4;  quarter ++) modelQuarterTurn(axis);
+    }
+    else if (operation == 1) {
+      cube.mirror(axis);
+      modelMirror(axis);
+    }
+    else {
+      byte axis2 = random(3);
+      cube.transpose(axis, axis2);
+      if (axis != axis2) modelTranspose(axis, axis2);
+    }
+
+    if (modelDiffers()  &&  mismatches ++ < 4) {
+      printf("transform %d on axis %d differs at step %d\n", operation, axis, step);
+    }
+  }
+
+  check(mismatches == 0, "transforms match voxel by voxel model");
+
+  // Four quarter turns, or a transpose done twice, change nothing
+  cube.rotate(Y);
+  cube.rotate(Y, 3);
+  cube.transpose(Z, X);
+  cube.transpose(X, Z);
+  check(! modelDiffers(), "transforms undone");
+}
+
+static bool triangleExpected(byte x, byte y, byte z)   { return(z == 0  &&  x + y <= CUBE_SIZE - 1); }
+static bool quadExpected(byte, byte, byte z)           { return(z == 1); }
+static bool slopeExpected(byte, byte y, byte z)        { return(z == y); }
+static bool clippedExpected(byte, byte, byte z)        { return(z == 0); }
+static bool thickExpected(byte, byte y, byte z)        { return((y == 1  ||  y == 2)  &&  (z == 1  ||  z == 2)); }
+static bool nothingExpected(byte, byte, byte)          { return(false); }
+
+int main(void) {
+  const byte L = CUBE_SIZE - 1;
+
+  hal_reset();
+  cube.begin(-1);
+
+  checkLines();
+
+  cube.all(BLACK);
+  memset(model, 0, sizeof(model));
+  checkBulk();
+
+  checkEllipsoids();
+
+  checkTransforms();
+
+  cube.all(BLACK);
+  cube.triangle(0, 0, 0, L, 0, 0, 0, L, 0, RED);
+  checkVoxels("triangle", triangleExpected);
+
+  cube.all(BLACK);
+  cube.quad(0, 0, 1, L, 0, 1, L, L, 1, 0, L, 1, GREEN);
+  checkVoxels("quad", quadExpected);
+
+  cube.all(BLACK);
+  cube.quad(0, 0, 0, L, 0, 0, L, L, L, 0, L, L, BLUE);
+  checkVoxels("sloping quad", slopeExpected);
+
+  cube.all(BLACK);
+  cube.triangle(0, 0, 0, 2 * L + 1, 0, 0, 0, 2 * L + 1, 0, RED);
+  checkVoxels("clipped triangle", clippedExpected);
+
+  cube.all(BLACK);
+  cube.line(0, 1, 1, L, 1, 1, WHITE, 2);
+  checkVoxels("thick line", thickExpected);
+  check(cursorX == L  &&  cursorY == 2  &&  cursorZ == 2, "thick line cursor");
+
+  cube.all(BLACK);
+  cube.set(1, 2, 3, BLACK);
+  cube.line(L + 1, L + 1, L + 1, L + 4, L + 4, L + 4, WHITE);
+  cube.triangle(L + 1, 0, 0, L + 2, 0, 0, L + 1, 1, 0, WHITE);
+  checkVoxels("outside", nothingExpected);
+  check(cursorX == 1  &&  cursorY == 2  &&  cursorZ == 3, "outside cursor");
+
+  return(checkPassed());
+}
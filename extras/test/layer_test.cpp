@@ -0,0 +1,164 @@
+/*
+ * File:    layer_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks the layer blend modes, and that composing only redoes the Z planes
+ * that have changed.  Built with CUBE_LAYERS 3.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Cube.h"
+#include "check.h"
+
+Cube cube;
+
+static bool near(byte value, double expected) {
+  return(abs(value - (int) (expected + 0.5)) <= 1);
+}
+
+static rgb_t composed(byte x, byte y, byte z) {
+  return(frameGet(ledBack, x, y, z));
+}
+
+// One voxel in layer 0 and layer 1, composed with layer 1's mode and opacity
+
+static rgb_t blend(rgb_t below, rgb_t above, byte mode, byte opacity) {
+  cube.layer(0);
+  cube.set(1, 2, 3, below);
+  cube.layer(1);
+  cube.set(1, 2, 3, above);
+  cube.layerBlend(1, mode, opacity);
+  cube.compose();
+  return(composed(1, 2, 3));
+}
+
+static void checkModes(void) {
+  rgb_t below = RGB(0x80, 0x40, 0xf0);
+  rgb_t above = RGB(0x40, 0xff, 0x00);
+  rgb_t rgb;
+
+  rgb = blend(below, above, LAYER_REPLACE, 255);
+  check(same(rgb, above), "replace");
+
+  rgb = blend(below, BLACK, LAYER_REPLACE, 255);
+  check(same(rgb, BLACK), "replace with black");
+
+  rgb = blend(below, above, LAYER_ALPHA, 255);
+  check(same(rgb, above), "alpha opaque");
+
+  rgb = blend(below, BLACK, LAYER_ALPHA, 255);
+  check(same(rgb, below), "alpha black is transparent");
+
+  rgb = blend(below, above, LAYER_ALPHA, 128);
+  check(near(rgb.color[0], 0x80 + (0x40 - 0x80) * 128 / 255.0)  &&
+        near(rgb.color[1], 0x40 + (0xff - 0x40) * 128 / 255.0)  &&
+        near(rgb.color[2], 0xf0 + (0x00 - 0xf0) * 128 / 255.0), "alpha half");
+
+  rgb = blend(below, above, LAYER_ADD, 255);
+  check(same(rgb, RGB(0xc0, 0xff, 0xf0)), "add saturates");
+
+  rgb = blend(below, above, LAYER_ADD, 64);
+  check(near(rgb.color[0], 0x80 + 0x40 * 64 / 255.0)  &&  near(rgb.color[1], 0x40 + 0xff * 64 / 255.0), "add quarter");
+
+  rgb = blend(below, WHITE, LAYER_MULTIPLY, 255);
+  check(same(rgb, below), "multiply by white");
+
+  rgb = blend(below, above, LAYER_MULTIPLY, 255);
+  check(near(rgb.color[0], 0x80 * 0x40 / 255.0)  &&  rgb.color[1] == 0x40  &&  rgb.color[2] == 0, "multiply");
+
+  rgb = blend(below, above, LAYER_MAX, 255);
+  check(same(rgb, RGB(0x80, 0xff, 0xf0)), "max");
+
+  rgb = blend(below, above, LAYER_REPLACE, 0);
+  check(same(rgb, below), "opacity 0 hides the layer");
+
+  cube.layer(1);
+  cube.set(1, 2, 3, BLACK);
+}
+
+// Composing must only redo the changed planes, and all of them when a
+// layer's blend settings change
+
+static void checkDirty(void) {
+  cube.layerBlend(1, LAYER_ALPHA, 255);
+  cube.layerBlend(2, LAYER_ADD, 255);
+  cube.layer(0);
+  cube.all(RGB(0x10, 0x10, 0x10));
+  cube.compose();
+
+  // Scribble on the composed frame, then draw in a single Z plane
+  framePut(ledBack, 0, 0, 0, RED);
+  framePut(ledBack, 0, 0, 2, RED);
+  cube.layer(2);
+  cube.set(3, 3, 2, RGB(0x20, 0, 0));
+  cube.compose();
+
+  check(same(composed(0, 0, 0), RED), "unchanged plane not composed");
+  check(same(composed(0, 0, 2), RGB(0x10, 0x10, 0x10)), "changed plane composed");
+  check(same(composed(3, 3, 2), RGB(0x30, 0x10, 0x10)), "changed plane blended");
+
+  cube.layerBlend(2, LAYER_ADD, 0);
+  cube.compose();
+  check(same(composed(0, 0, 0), RGB(0x10, 0x10, 0x10))  &&  same(composed(3, 3, 2), RGB(0x10, 0x10, 0x10)),
+    "blend change composes all planes");
+
+  // An opaque replace layer hides the layers below
+  cube.layer(1);
+  cube.all(BLUE);
+  cube.layerBlend(1, LAYER_REPLACE, 255);
+  cube.compose();
+  check(same(composed(2, 2, 2), BLUE), "opaque replace layer");
+}
+
+static void checkPoll(void) {
+  cube.layerBlend(1, LAYER_ALPHA, 255);
+  cube.layerBlend(2, LAYER_MAX, 255);
+  cube.layer(0);
+  cube.all(BLACK);
+  cube.layer(1);
+  cube.all(BLACK);
+
+  // Drawing is composed by poll(), via the serial commands too
+  char layer[] = "layer 2";
+  char set[]   = "set 123 00ff00";
+  bytecode_t bytecode = {};
+  check(parser(layer, strlen(layer), & bytecode) == 0, "layer command");
+  check(parser(set, strlen(set), & bytecode) == 0, "set command");
+  cube.poll();
+  check(same(composed(1, 2, 3), GREEN), "composed by poll()");
+
+  char mode[] = "layer 2 1 0";
+  check(parser(mode, strlen(mode), & bytecode) == 0, "layer blend command");
+  cube.poll();
+  check(same(composed(1, 2, 3), BLACK), "layer blend command composed");
+
+#ifndef NO_DOUBLE_BUFFER
+  // Double buffered, show() composes into the back buffer
+  cube.layerBlend(2, LAYER_MAX, 255);
+  cube.doubleBuffer(true);
+  cube.poll();
+  rgb_t shown = frameGet(ledDisplay, 1, 2, 3);
+  cube.show();
+  hal_run((unsigned long long) hal_refresh_cycles() * COLOR_PLANES * CUBE_SIZE * 2);
+  check(same(shown, BLACK)  &&  same(frameGet(ledDisplay, 1, 2, 3), GREEN), "double buffered show()");
+
+  cube.suspend();                  // Nothing interrupts waitForShow() on the host
+  cube.doubleBuffer(false);
+  cube.resume();
+#endif
+}
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+
+  checkModes();
+  checkDirty();
+  checkPoll();
+
+  return(checkPassed());
+}
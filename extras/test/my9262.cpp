@@ -0,0 +1,138 @@
+/*
+ * File:    my9262.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ */
+
+#include "my9262.h"
+
+my9262_t my9262;
+
+static void clock(
+  byte bit) {
+
+  for (byte chip = MY9262_CHAIN - 1;  chip > 0;  chip --) {
+    my9262.shift[chip] = (my9262.shift[chip] << 1) | (my9262.shift[chip - 1] >> 15);
+  }
+  my9262.shift[0] = (my9262.shift[0] << 1) | bit;
+  my9262.clocks ++;
+  if (my9262.latHigh) my9262.latClocks ++;
+}
+
+static void globalLatch(void) {
+  if (my9262.dataCount != MY9262_CHANNELS - 1) my9262.errors ++;
+  if (my9262.enabled) my9262.ghosts ++;
+
+  for (byte chip = 0;  chip < MY9262_CHAIN;  chip ++) {
+    my9262.data[chip][MY9262_CHANNELS - 1] = my9262.shift[chip];
+  }
+  memcpy(my9262.output, my9262.data, sizeof(my9262.output));
+  my9262.dataCount = 0;
+  my9262.globalLatches ++;
+
+  unsigned long long now = hal_cycles();
+  if (my9262.globalLatches > 1) {
+    unsigned long long interval = now - my9262.globalLatchTime;
+    if (my9262.globalLatches == 2  ||  interval < my9262.globalLatchMin) my9262.globalLatchMin = interval;
+    if (interval > my9262.globalLatchMax) my9262.globalLatchMax = interval;
+  }
+  my9262.globalLatchTime = now;
+}
+
+static void latchFalling(void) {
+  switch (my9262.latClocks) {
+    case 0:                      // No effect
+      break;
+
+    case 1:
+      if (my9262.dataCount < MY9262_CHANNELS - 1) {
+        for (byte chip = 0;  chip < MY9262_CHAIN;  chip ++) {
+          my9262.data[chip][my9262.dataCount] = my9262.latShift[chip];
+        }
+        my9262.dataCount ++;
+      }
+      else {
+        my9262.errors ++;
+      }
+      my9262.dataLatches ++;
+      break;
+
+    case 2:
+      globalLatch();
+      break;
+
+    case 10:
+      memcpy(my9262.command, my9262.shift, sizeof(my9262.command));
+      my9262.commands ++;
+      break;
+
+    default:
+      my9262.errors ++;
+      break;
+  }
+}
+
+static void enable(void) {
+  for (byte w = 0;  w < PLANE_VOXELS;  w ++) {
+    my9262.display[my9262.select][w] = my9262.output[MY9262_CHAIN - 1 - w % MY9262_CHAIN][w / MY9262_CHAIN];
+  }
+}
+
+static void planeSelect(
+  uint8_t select) {
+
+  my9262.select = select;
+  if (my9262.enabled) enable();
+}
+
+static void registerWrite(
+  hal_register *reg,
+  uint8_t       before,
+  uint8_t       after) {
+
+  if (reg == &SPDR) {
+    if (SPCR & _BV(SPE)) {
+      for (int bit = 7;  bit >= 0;  bit --) clock((after >> bit) & 1);  // MSB first
+    }
+  }
+  else if (reg == &PORTB) {
+#ifndef CUBE_PLANE_SELECT
+    if ((before >> 4) != (after >> 4)) planeSelect(after >> 4);
+#endif
+
+    if (! (before & _BV(1))  &&  (after & _BV(1))) clock((after >> 2) & 1);
+  }
+  else if (reg == &PORTD) {
+    bool latHigh = after & _BV(6);
+
+    if (latHigh  &&  ! my9262.latHigh) {
+      my9262.latClocks = 0;
+      memcpy(my9262.latShift, my9262.shift, sizeof(my9262.latShift));
+    }
+    my9262.latHigh = latHigh;
+
+    if (! latHigh  &&  (before & _BV(6))) latchFalling();
+  }
+  else if (reg == &PORTE) {
+    my9262.enabled = ! (after & _BV(6));
+    if (my9262.enabled  &&  (before & _BV(6))) enable();
+  }
+}
+
+void my9262ResetCounts(void) {
+  my9262.clocks = my9262.dataLatches = my9262.globalLatches = 0;
+  my9262.commands = my9262.ghosts = my9262.errors = 0;
+  my9262.globalLatchMin = my9262.globalLatchMax = 0;
+}
+
+void my9262Attach(void) {
+  memset(&my9262, 0, sizeof(my9262));
+  hal_on_register_write = registerWrite;
+  hal_on_plane_select   = planeSelect;
+}
+
+void my9262Detach(void) {
+  hal_on_register_write = NULL;
+  hal_on_plane_select   = NULL;
+}
@@ -0,0 +1,70 @@
+/*
+ * File:    my9262.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Host emulation of the Cube's LED drivers: the chain of MY9262 16 channel
+ * constant current drivers (one for a 4x4x4 cube) and the 74154 decoder that
+ * selects a color plane of a Z plane.  Driven by the simulated pins and SPI
+ * data register (see extras/host/hal.h), it rebuilds what is displayed, bit
+ * for bit.
+ *
+ * Pins: SCK PB1, MOSI PB2, 74154 select PB4..7, MY9262 LAT PD6, 74154 EN PE6.
+ * Cubes with more color planes than 74154 outputs use CUBE_PLANE_SELECT().
+ *
+ * The number of SCK clocks while LAT is high decides what LAT does ...
+ *   1:  Data latch, the 16 bits shifted before LAT went high
+ *   2:  Global latch, the last 16 bits shifted, then all 16 to the outputs
+ *   10: Write command register
+ *
+ * Each MY9262 shifts out the bit shifted out of its 16 bit shift register
+ * into the next one, so after a word for each MY9262 the first word sent is
+ * in the last MY9262.  Every MY9262 latches at once.
+ */
+
+#ifndef MY9262_h
+#define MY9262_h
+
+#include "Cube.h"
+
+static const byte DECODER_OUTPUTS = (CUBE_SIZE * COLOR_PLANES > 16)  ?  CUBE_SIZE * COLOR_PLANES  :  16;
+
+typedef struct {
+  uint16_t      shift[MY9262_CHAIN];         // 16 bit shift registers
+  uint16_t      data[MY9262_CHAIN][MY9262_CHANNELS];    // Data latched words
+  byte          dataCount;
+  uint16_t      output[MY9262_CHAIN][MY9262_CHANNELS];  // Global latched, driving LEDs
+  uint16_t      command[MY9262_CHAIN];
+
+  bool          latHigh;
+  byte          latClocks;                   // SCK clocks while LAT is high
+  uint16_t      latShift[MY9262_CHAIN];      // Shift registers when LAT rose
+
+  bool          enabled;                     // 74154 EN is low
+  byte          select;                      // 74154 output
+
+  // The MY9262 outputs each time a 74154 output was enabled, in wire order
+  // (y * CUBE_SIZE + x, as loaded by Cube.cpp)
+  uint16_t      display[DECODER_OUTPUTS][PLANE_VOXELS];
+
+  unsigned long clocks;
+  unsigned long dataLatches;
+  unsigned long globalLatches;
+  unsigned long commands;
+  unsigned long ghosts;                      // Global latch while enabled
+  unsigned long errors;                      // Unexpected latch sequences
+
+  unsigned long long globalLatchTime;        // hal_cycles() of last global latch
+  unsigned long long globalLatchMin;         // Cycles between global latches
+  unsigned long long globalLatchMax;
+}
+  my9262_t;
+
+extern my9262_t my9262;
+
+extern void my9262Attach(void);  // Reset and start watching the pins
+extern void my9262Detach(void);
+extern void my9262ResetCounts(void);
+
+#endif
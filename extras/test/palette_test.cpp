@@ -0,0 +1,190 @@
+/*
+ * File:    palette_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks indexed color frames: packing, nearest palette colors, the bulk
+ * operations against a voxel by voxel model, and palette changes.  Built
+ * with CUBE_PALETTE 16 (4 bit indexes) and 64 (8 bit indexes).
+ */
+
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+
+Cube cube;
+
+// The default palette colors, all different
+
+static const byte DISTINCT = 16;
+
+static rgb_t model[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+static bool modelDiffers(void) {
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        if (! same(frameGet(led, x, y, z), model[x][y][z])) return(true);
+      }
+    }
+  }
+
+  return(false);
+}
+
+static rgb_t *modelVoxel(byte axis, byte position, byte i, byte j) {
+  if (axis == X) return(& model[position][i][j]);
+  if (axis == Y) return(& model[i][position][j]);
+  return(& model[i][j][position]);
+}
+
+static void checkBulk(void) {
+  const byte L = CUBE_SIZE - 1;
+  unsigned int mismatches = 0;
+
+  cube.all(BLACK);
+  for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+    for (byte j = 0;  j < CUBE_SIZE;  j ++) {
+      for (byte k = 0;  k < CUBE_SIZE;  k ++) model[i][j][k] = BLACK;
+    }
+  }
+
+  for (unsigned int step = 0;  step < 3000;  step ++) {
+    byte  axis = random(3);
+    byte  position = random(CUBE_SIZE);
+    byte  destination = random(CUBE_SIZE);
+    rgb_t rgb = cube.paletteColor(random(DISTINCT));
+    byte  operation = random(5);
+
+    if (operation == 0) {
+      byte x = random(CUBE_SIZE), y = random(CUBE_SIZE), z = random(CUBE_SIZE);
+      cube.set(x, y, z, rgb);
+      model[x][y][z] = rgb;
+    }
+    else if (operation == 1) {
+      cube.setplane(axis, position, rgb);
+      for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+        for (byte j = 0;  j < CUBE_SIZE;  j ++) *modelVoxel(axis, position, i, j) = rgb;
+      }
+    }
+    else if (operation == 2) {
+      cube.copyplane(axis, position, destination);
+      for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+        for (byte j = 0;  j < CUBE_SIZE;  j ++) *modelVoxel(axis, destination, i, j) = *modelVoxel(axis, position, i, j);
+      }
+    }
+    else if (operation == 3) {
+      byte direction = random(2)  ?  '+'  :  '-';
+      cube.shift(axis, direction);
+      for (byte n = 0;  n < L;  n ++) {
+        byte to   = (direction == '+')  ?  L - n  :  n;
+        byte from = (direction == '+')  ?  to - 1  :  to + 1;
+        for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+          for (byte j = 0;  j < CUBE_SIZE;  j ++) *modelVoxel(axis, to, i, j) = *modelVoxel(axis, from, i, j);
+        }
+      }
+      for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+        for (byte j = 0;  j < CUBE_SIZE;  j ++) *modelVoxel(axis, (direction == '+')  ?  0  :  L, i, j) = BLACK;
+      }
+    }
+    else {
+      cube.mirror(axis);
+      for (byte n = 0;  n < CUBE_SIZE / 2;  n ++) {
+        for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+          for (byte j = 0;  j < CUBE_SIZE;  j ++) {
+            rgb_t swap = *modelVoxel(axis, n, i, j);
+            *modelVoxel(axis, n, i, j) = *modelVoxel(axis, L - n, i, j);
+            *modelVoxel(axis, L - n, i, j) = swap;
+          }
+        }
+      }
+    }
+
+    if (modelDiffers()  &&  mismatches ++ < 4) {
+      printf("operation %d on axis %d differs at step %d\n", operation, axis, step);
+    }
+  }
+
+  check(mismatches == 0, "bulk operations match voxel by voxel model");
+}
+
+static void checkColors(void) {
+  const byte L = CUBE_SIZE - 1;
+
+  for (byte index = 0;  index < DISTINCT;  index ++) {
+    cube.set(1, 2, 3, cube.paletteColor(index));
+    if (frameGetIndex(led, 1, 2, 3) != index) {
+      printf("palette color %d drawn as %d\n", index, frameGetIndex(led, 1, 2, 3));
+      check(false, "palette colors drawn exactly");
+    }
+  }
+
+  cube.set(0, 0, 1, RGB(0xf0, 0x10, 0x08));
+  check(same(frameGet(led, 0, 0, 1), RED), "nearest palette color");
+
+  cube.set(0, 0, 1, RGB(0x70, 0x70, 0x70));
+  check(same(frameGet(led, 0, 0, 1), RGB(0x80, 0x80, 0x80)), "nearest grey");
+
+  // Changing a palette color must not leave the last color looked up stale
+  cube.set(0, 0, 0, RED);
+  cube.palette(1, RGB(0x00, 0x00, 0x10));
+  cube.set(0, 0, 1, RED);
+  check(same(frameGet(led, 0, 0, 0), RGB(0x00, 0x00, 0x10)), "palette change recolors voxels");
+  check(same(frameGet(led, 0, 0, 1), ORANGE), "nearest after palette change");
+  cube.palette(1, RED);
+
+  // Voxels moved around keep their palette index, even when another entry
+  // has the same color
+  cube.set(0, 0, 0, cube.paletteColor(2));
+  cube.palette(2, RED);
+  cube.mirror(X);
+  cube.rotate(Z);
+  cube.palette(2, GREEN);
+  check(same(frameGet(led, L, L, 0), GREEN), "transforms keep palette indexes");
+
+  cube.palette(CUBE_PALETTE, WHITE);
+  check(same(cube.paletteColor(0), BLACK), "palette index out of range");
+}
+
+static void checkRotate(void) {
+  rgb_t colors[4] = { RGB(1, 0, 0), RGB(2, 0, 0), RGB(3, 0, 0), RGB(4, 0, 0) };
+
+  for (byte index = 0;  index < 4;  index ++) cube.palette(index + 1, colors[index]);
+
+  cube.all(BLACK);
+  cube.set(2, 1, 0, colors[1]);                    // Index 2
+  cube.paletteRotate(1, 4);
+  check(same(cube.paletteColor(1), colors[3])  &&  same(cube.paletteColor(2), colors[0])  &&
+        same(cube.paletteColor(4), colors[2]), "rotate up");
+  check(same(frameGet(led, 2, 1, 0), colors[0]), "rotate recolors voxels");
+
+  cube.paletteRotate(1, 4, '-');
+  cube.paletteRotate(1, 4, '-');
+  check(same(cube.paletteColor(1), colors[1])  &&  same(cube.paletteColor(4), colors[0]), "rotate down");
+
+  // And via the serial commands
+  char palette[] = "palette 2 ff00ff";
+  char rotate[]  = "paletterotate 2 3 -";
+  bytecode_t bytecode = {};
+  check(parser(palette, strlen(palette), & bytecode) == 0, "palette command");
+  check(same(cube.paletteColor(2), PURPLE), "palette command color");
+  check(parser(rotate, strlen(rotate), & bytecode) == 0, "paletterotate command");
+  check(same(cube.paletteColor(3), PURPLE), "paletterotate command colors");
+
+  cubePaletteReset();
+}
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+
+  check(sizeof(frame_t) == CUBE_SIZE * PLANE_VOXELS / ((CUBE_PALETTE <= 16)  ?  2  :  1), "frame size");
+
+  checkColors();
+  checkBulk();
+  checkRotate();
+
+  return(checkPassed());
+}
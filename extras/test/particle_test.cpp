@@ -0,0 +1,200 @@
+/*
+ * File:    particle_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks particles (see particle.cpp) against a model of the fixed point
+ * motion, lifetime and colour ramp, and the pool, emitters, additive
+ * drawing and trails.  Built with CUBE_PARTICLES 16.
+ */
+
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+
+Cube cube;
+
+static unsigned int litVoxels(void) {
+  unsigned int lit = 0;
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+        if (! same(frameGet(led, x, y, z), BLACK)) lit ++;
+      }
+    }
+  }
+
+  return(lit);
+}
+
+static void reset(void) {
+  cube.particleClear();
+  cube.particleEmitter(0, NULL);
+  cube.particleEmitter(1, NULL);
+  cube.particleGravity(0, 0, 0);
+  cube.particleTrail(0);
+  cube.all(BLACK);
+}
+
+// One particle thrown sideways, falling under gravity until it leaves the
+// cube, drawn at the modelled voxel each step
+
+static void checkMotion(void) {
+  const particle_emitter_t thrown = {
+    PARTICLE_VOXEL / 2, PARTICLE_VOXEL / 2, CUBE_SIZE * PARTICLE_VOXEL - 1,
+    0, 0, 0,
+    PARTICLE_VOXEL / 8, PARTICLE_VOXEL / 16, 0,
+    0,
+    0, 255,
+    WHITE, WHITE
+  };
+  int x = thrown.x, y = thrown.y, z = thrown.z;
+  int vx = thrown.vx, vy = thrown.vy, vz = thrown.vz;
+  unsigned int steps = 0, mismatches = 0;
+
+  reset();
+  cube.particleEmitter(0, & thrown);
+  cube.particleGravity(0, 0, -PARTICLE_VOXEL / 32);
+  cube.particleBurst(0, 1);
+  check(cube.particleCount() == 1, "burst of one");
+
+  while (cube.particleCount() > 0  &&  steps < 100) {
+    cube.particleStep();
+    steps ++;
+
+    if (! same(frameGet(led, x >> 8, y >> 8, z >> 8), WHITE)  ||  litVoxels() != 1) mismatches ++;
+
+    vz -= PARTICLE_VOXEL / 32;
+    x += vx;  y += vy;  z += vz;
+  }
+
+  check(mismatches == 0, "motion");
+  check(z < 0  &&  x < CUBE_SIZE * PARTICLE_VOXEL, "left through the floor");
+  check(steps > 3  &&  steps < 100, "falls out");
+}
+
+// A still particle fading from RED to BLACK over its life
+
+static void checkLife(void) {
+  const byte LIFE = 4;
+  const particle_emitter_t ember = {
+    PARTICLE_VOXEL, PARTICLE_VOXEL, PARTICLE_VOXEL,
+    0, 0, 0,  0, 0, 0,  0,
+    0, LIFE,
+    RED, BLACK
+  };
+  unsigned int ageStep = 0xffff / LIFE;
+
+  reset();
+  cube.particleEmitter(0, & ember);
+  cube.particleBurst(0, 1);
+
+  for (byte step = 0;  step < LIFE;  step ++) {
+    cube.particleStep();
+    byte red = (0xff * (256 - ((step * ageStep) >> 8))) >> 8;
+    check(same(frameGet(led, 1, 1, 1), RGB(red, 0, 0)), "colour ramp");
+  }
+
+  check(cube.particleCount() == 0, "dies after its life");
+  cube.particleStep();
+  check(litVoxels() == 0, "not drawn once dead");
+}
+
+static void checkPool(void) {
+  const particle_emitter_t spark = {
+    PARTICLE_VOXEL, PARTICLE_VOXEL, PARTICLE_VOXEL,
+    0, 0, 0,  0, 0, 0,  0,
+    0, 255,
+    RGB(0x90, 0x00, 0x10), RGB(0x90, 0x00, 0x10)
+  };
+
+  reset();
+  cube.particleEmitter(0, & spark);
+  cube.particleBurst(0, 2);
+  cube.particleStep();
+  check(same(frameGet(led, 1, 1, 1), RGB(0xff, 0x00, 0x20)), "additive, saturating");
+
+  cube.particleBurst(0, 200);
+  check(cube.particleCount() == CUBE_PARTICLES, "pool full");
+  cube.particleBurst(PARTICLE_EMITTERS, 1);
+  check(cube.particleCount() == CUBE_PARTICLES, "no such emitter");
+
+  // Starting outside the cube
+  particle_emitter_t outside = spark;
+  outside.z = CUBE_SIZE * PARTICLE_VOXEL;
+  reset();
+  cube.particleEmitter(1, & outside);
+  cube.particleBurst(1, 3);
+  check(cube.particleCount() == 0, "started outside");
+
+  // One particle every 4 steps, across the top plane
+  particle_emitter_t rain = spark;
+  rain.x     = 0;
+  rain.y     = 0;
+  rain.z     = (CUBE_SIZE - 1) * PARTICLE_VOXEL;
+  rain.areaX = CUBE_SIZE * PARTICLE_VOXEL;
+  rain.areaY = CUBE_SIZE * PARTICLE_VOXEL;
+  rain.rate  = PARTICLE_VOXEL / 4;
+  reset();
+  cube.particleEmitter(0, & rain);
+  for (byte step = 0;  step < 16;  step ++) cube.particleStep();
+  check(cube.particleCount() == 4, "emitter rate");
+
+  cube.particleEmitter(0, NULL);
+  for (byte step = 0;  step < 16;  step ++) cube.particleStep();
+  check(cube.particleCount() == 4  &&  litVoxels() > 0, "emitter stopped, particles live on");
+
+  bool colours = true;
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      rgb_t rgb = frameGet(led, x, y, CUBE_SIZE - 1);
+      if (! same(rgb, BLACK)  &&  (rgb.color[0] < 0x90  ||  rgb.color[1] != 0)) colours = false;
+    }
+  }
+  check(colours, "stopped emitter keeps its colours");
+}
+
+// One voxel a step along X, the voxels behind dimming by half each step
+
+static void checkTrail(void) {
+  const particle_emitter_t comet = {
+    0, 0, 0,
+    0, 0, 0,
+    PARTICLE_VOXEL, 0, 0,
+    0,
+    0, 255,
+    WHITE, WHITE
+  };
+
+  reset();
+  cube.particleEmitter(0, & comet);
+  cube.particleTrail(128);
+  cube.particleBurst(0, 1);
+  cube.particleStep();
+  cube.particleStep();
+  cube.particleStep();
+
+  check(same(frameGet(led, 2, 0, 0), WHITE), "comet");
+  check(same(frameGet(led, 1, 0, 0), RGB(0x7f, 0x7f, 0x7f)), "trail");
+  check(same(frameGet(led, 0, 0, 0), RGB(0x3f, 0x3f, 0x3f)), "trail fading");
+
+  cube.particleTrail(0);
+  cube.particleStep();
+  check(litVoxels() == 1, "no trail");
+}
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+  srand(1);
+
+  checkMotion();
+  checkLife();
+  checkPool();
+  checkTrail();
+
+  return(checkPassed());
+}
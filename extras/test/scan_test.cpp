@@ -0,0 +1,157 @@
+/*
+ * File:    scan_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks that the refresh interrupt puts exactly the display buffer on the
+ * LEDs, by running it into the MY9262 / 74154 emulator.  Also reports the
+ * SCK clocks per frame and the time between global latches.
+ */
+
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+#include "gamma.h"
+#include "my9262.h"
+
+static const unsigned int CLOCKS_PER_PLANE = PLANE_VOXELS * 16 + MY9262_CHANNELS - 1;
+
+Cube cube;
+
+static unsigned int wireValue(
+  byte color,
+  byte value) {
+
+#ifdef CUBE_GAMMA
+  return(pgm_read_word(GAMMA_MAP(color) + value));
+#else
+  (void) color;
+  return(value << 8);
+#endif
+}
+
+static void runFrames(
+  byte frames) {
+
+  hal_run((unsigned long long) hal_refresh_cycles() * COLOR_PLANES * CUBE_SIZE * frames);
+}
+
+// Each color plane of each Z plane, as displayed, matches the display buffer
+
+static void checkDisplay(
+  const char *name) {
+
+  byte mismatches = 0;
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+      uint16_t *output = my9262.display[color + z * COLOR_PLANES];
+
+      for (byte voxel = 0;  voxel < PLANE_VOXELS;  voxel ++) {
+        byte x = voxel % CUBE_SIZE;
+        byte y = voxel / CUBE_SIZE;
+        unsigned int expected = wireValue(color, frameGetColor(ledDisplay, x, y, z, color));
+
+        if (output[voxel] != expected) {
+          if (mismatches ++ < 4) {
+            printf("%s: x %d y %d z %d color %d: displayed 0x%04x, expected 0x%04x\n",
+              name, x, y, z, color, output[voxel], expected);
+          }
+        }
+      }
+    }
+  }
+
+  check(mismatches == 0, name);
+}
+
+static void checkTiming(void) {
+  unsigned long planes = my9262.globalLatches;
+
+  check(planes > 0, "global latches");
+  check(my9262.errors == 0, "latch sequence");
+  check(my9262.dataLatches == planes * (MY9262_CHANNELS - 1), "data latches per plane");
+  check(my9262.clocks == planes * CLOCKS_PER_PLANE, "clocks per plane");
+  check(my9262.globalLatchMin == hal_refresh_cycles(), "minimum global latch interval");
+  check(my9262.globalLatchMax == hal_refresh_cycles(), "maximum global latch interval");
+}
+
+int main(void) {
+  hal_reset();
+  my9262Attach();
+  srand(1);
+
+  cube.begin(-1);
+
+  for (byte chip = 0;  chip < MY9262_CHAIN;  chip ++) {
+    check(my9262.commands == 1  &&  my9262.command[chip] == 0x0ff0, "write command");
+  }
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+        cube.set(x, y, z, RGB((byte) random(256), (byte) random(256), (byte) random(256)));
+      }
+    }
+  }
+
+  my9262ResetCounts();
+  runFrames(2);
+  checkDisplay("random voxels");
+  checkTiming();
+
+  printf("SCK clocks per frame: %lu\n", my9262.clocks * COLOR_PLANES * CUBE_SIZE / my9262.globalLatches);
+  printf("global latch interval: %llu cycles\n", my9262.globalLatchMax);
+
+  // Only some slices change
+
+  cube.sphere(1, 1, 1, 2, ORANGE);
+  cube.setplane(Y, 0, RGB(0x01, 0x80, 0xfe));
+  cube.shift(X, '+');
+  runFrames(1);
+  checkDisplay("redrawn slices");
+
+  // Double buffered
+
+  cube.doubleBuffer(true);
+  cube.all(BLUE);
+  cube.line(0, 0, 0, CUBE_SIZE - 1, CUBE_SIZE - 1, CUBE_SIZE - 1, WHITE);
+  runFrames(1);
+#ifndef NO_DOUBLE_BUFFER
+  check(frameGetColor(ledDisplay, 0, 0, 0, COLOR_PLANE_BLUE) != 0xff, "back buffer not shown");
+#endif
+  cube.show();
+  runFrames(2);
+  checkDisplay("double buffered");
+
+#ifdef CUBE_PALETTE
+  // A palette change shows at once, and in the other buffer after a swap
+
+  cube.palette(3, RGB(0x12, 0x34, 0x56));          // Was BLUE
+  runFrames(1);
+  checkDisplay("palette change");
+  check(frameGetColor(ledDisplay, 1, 0, 0, COLOR_PLANE_GREEN) == 0x34, "palette change displayed");
+  cube.all(GREEN);
+  cube.show();
+  runFrames(2);
+  checkDisplay("palette change swapped");
+  cube.paletteRotate(1, 4);
+  runFrames(1);
+  checkDisplay("palette rotated");
+
+#endif
+  // Shorter refresh period
+
+  cube.setRefreshPeriod(250);
+  runFrames(1);
+  my9262ResetCounts();
+  cube.box(0, 0, 0, CUBE_SIZE - 1, CUBE_SIZE - 1, CUBE_SIZE - 1, RED, 4, GREEN);
+  cube.show();
+  runFrames(2);
+  checkDisplay("refresh period 250");
+  checkTiming();
+
+  return(checkPassed());
+}
@@ -0,0 +1,287 @@
+/*
+ * File:    spectrum_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks the audio spectrum (see spectrum.cpp) with tones fed to the
+ * simulated ADC: the ADC set up, the sample rate, each band picking out its
+ * own frequency, the bars, the levels falling, recorded sample files and the
+ * serial command.  Built with CUBE_SPECTRUM.
+ *
+ * Usage: spectrum_test [recording.raw]
+ *   Given a recording (see hal_adc_load() in extras/host/hal.h), prints the
+ *   levels of each frame instead.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+
+static const unsigned long TICK_CYCLES = F_CPU / 1000;   // Poll every 1 ms
+static const byte          PIN         = 4;             // A4
+static const uint16_t      MIDDLE      = 512;           // 10 bit silence
+
+Cube cube;
+
+static void tick(void) {
+  hal_run(TICK_CYCLES);
+  cube.poll();
+}
+
+static void run(
+  unsigned int milliseconds) {
+
+  for (unsigned int count = 0;  count < milliseconds;  count ++) tick();
+}
+
+// Sine waves at the bins of bands1 and 2, 10 bits, as sampled by the ADC
+
+static void tone(
+  byte         band1,
+  byte         band2,
+  unsigned int samples,
+  int          amplitude = 400) {
+
+  for (unsigned int sample = 0;  sample < samples;  sample ++) {
+    double value = MIDDLE;
+
+    for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) {
+      if (band == band1  ||  band == band2) {
+        value += amplitude * sin(2 * M_PI * spectrumBins[band] * sample / SPECTRUM_SAMPLES);
+      }
+    }
+
+    hal_adc_samples.push_back(lround(value));
+  }
+}
+
+static byte loudest(
+  byte except = SPECTRUM_BANDS) {
+
+  byte loudest = (except == 0)  ?  1  :  0;
+
+  for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) {
+    if (band != except  &&  cube.spectrumLevel(band) > cube.spectrumLevel(loudest)) loudest = band;
+  }
+
+  return(loudest);
+}
+
+// Voxels of the bars that differ from the levels
+
+static unsigned int mismatches(
+  frame_t *frame) {
+
+  const byte width = CUBE_SIZE / 4;
+  unsigned int wrong = 0;
+
+  for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) {
+    int height = ((int) cube.spectrumLevel(band) - SPECTRUM_FLOOR) * CUBE_SIZE / SPECTRUM_RANGE;
+    height = constrain(height, 0, CUBE_SIZE);
+
+    for (byte x = (band % 4) * width;  x < (band % 4 + 1) * width;  x ++) {
+      for (byte y = (band / 4) * width;  y < (band / 4 + 1) * width;  y ++) {
+        for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+          rgb_t expected = (z + 1 < height)  ?  GREEN  :  (z + 1 == height)  ?  RED  :  BLACK;
+          if (! same(frameGet(frame, x, y, z), expected)) wrong ++;
+        }
+      }
+    }
+  }
+
+  return(wrong);
+}
+
+static void checkADC(void) {
+  cube.spectrum(A4);
+
+  check(ADMUX == (_BV(REFS0) | _BV(ADLAR) | 1)  &&  ADCSRB == 0, "A4 is channel 1, 8 bits");
+  check(ADCSRA == (_BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0)), "free running");
+
+  // 25 ADC clocks for the first conversion, then 13 each
+  tone(0, 0, 1000);
+  run(50);
+  unsigned long conversions = 1 + (50 * TICK_CYCLES - 25 * 128) / (13 * 128);
+  check(hal_adc_samples.size() == 1000 - conversions, "sample rate");
+  check(conversions / 50 == SPECTRUM_RATE / 1000, "SPECTRUM_RATE");
+
+  cube.spectrumStop();
+  hal_adc_samples.clear();
+  check(ADCSRA == (_BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0)), "stopped");
+
+  cube.spectrum(PIN + 2);                              // A6, channel 8
+  check((ADMUX & 0x07) == 0  &&  ADCSRB == _BV(MUX5), "A6 is channel 8");
+  cube.spectrumStop();
+}
+
+// Each band's tone is its loudest band, well up the bar, and the bars are
+// drawn from the levels
+
+static void checkBands(void) {
+  unsigned int wrong = 0, quiet = 0, undrawn = 0;
+
+  for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) {
+    cube.all(BLACK);
+    cube.spectrum(A4);
+    tone(band, band, SPECTRUM_RATE / 10);
+    run(80);
+
+    byte level = cube.spectrumLevel(band);
+
+    if (loudest() != band  ||  cube.spectrumLevel(loudest(band)) + 8 > level) {
+      if (wrong ++ < 4) printf("band %d: level %d, loudest %d\n", band, level, loudest());
+    }
+
+    if (level < SPECTRUM_FLOOR + SPECTRUM_RANGE / 2) quiet ++;
+    if (mismatches(led)) undrawn ++;
+
+    cube.spectrumStop();
+    hal_adc_samples.clear();
+  }
+
+  check(wrong == 0, "each band picks out its frequency");
+  check(quiet == 0, "tones fill half the bar");
+  check(undrawn == 0, "bars");
+}
+
+// Silence after a tone: the levels fall SPECTRUM_DECAY each frame, to empty
+
+static void checkDecay(void) {
+  unsigned int frames = 0, wrong = 0;
+
+  hal_analog[PIN] = MIDDLE;
+  cube.spectrum(A4);
+  tone(5, 5, SPECTRUM_RATE / 10);
+  run(80);
+
+  byte last = cube.spectrumLevel(5);
+  hal_adc_samples.clear();
+
+  for (unsigned int count = 0;  count < 1000;  count ++) {
+    tick();
+    byte level = cube.spectrumLevel(5);
+
+    if (level != last) {
+      frames ++;
+      if (level > last  ||  (last - level != SPECTRUM_DECAY  &&  level != 0)) wrong ++;
+    }
+
+    last = level;
+  }
+
+  check(frames > 10  &&  wrong == 0, "levels fall");
+  check(cube.spectrumLevel(loudest()) < SPECTRUM_FLOOR, "silence");
+  check(mismatches(led) == 0  &&  same(frameGet(led, 0, 0, 0), BLACK), "empty bars");
+
+  cube.spectrumStop();
+}
+
+// A recording of two tones, through a file
+
+static void checkRecording(void) {
+  const char *path = "spectrum_test.raw";
+  FILE *file = fopen(path, "wb");
+
+  tone(3, 12, SPECTRUM_RATE / 10, 200);
+  while (! hal_adc_samples.empty()) {
+    fputc(hal_adc_samples.front() >> 2, file);
+    hal_adc_samples.pop_front();
+  }
+  fclose(file);
+
+  check(hal_adc_load(path)  &&  hal_adc_samples.size() == SPECTRUM_RATE / 10, "load recording");
+  remove(path);
+
+  cube.spectrum(A4);
+  run(80);
+
+  byte first = loudest(), second = loudest(first);
+  check((first == 3  &&  second == 12)  ||  (first == 12  &&  second == 3), "two tones");
+
+  cube.spectrumStop();
+  hal_adc_samples.clear();
+  check(! hal_adc_load("/nonexistent/recording.raw"), "no recording");
+}
+
+static void checkSerial(void) {
+  bytecode_t bytecode = {};
+
+  char start[] = "spectrum 4";
+  check(parser(start, strlen(start), & bytecode) == 0  &&  (ADCSRA & _BV(ADIE))  &&  (ADMUX & 0x07) == 1, "spectrum command");
+
+  char stop[] = "spectrum";
+  check(parser(stop, strlen(stop), & bytecode) == 0  &&  ! (ADCSRA & _BV(ADIE)), "spectrum stops");
+
+  char bad[] = "spectrum 12";
+  check(parser(bad, strlen(bad), & bytecode) != 0, "no such input");
+
+  // A6 to A11 share pins with the cube on a Leonardo
+  bool rejected = true;
+  for (byte pin = 6;  pin <= 11;  pin ++) {
+    char shared[16];
+    snprintf(shared, sizeof(shared), "spectrum %d", pin);
+    if (parser(shared, strlen(shared), & bytecode) == 0  ||  (ADCSRA & _BV(ADIE))) rejected = false;
+  }
+  check(rejected, "cube's pins rejected");
+}
+
+#ifndef NO_DOUBLE_BUFFER
+// Each frame is shown when double buffering
+
+static void checkDoubleBuffered(void) {
+  cube.all(BLACK);
+  cube.doubleBuffer(true);
+  cube.spectrum(A4);
+  tone(9, 9, SPECTRUM_RATE / 10);
+  run(55);
+  cube.spectrumStop();                 // Between frames
+  run(10);
+
+  check(mismatches(ledDisplay) == 0  &&  cube.spectrumLevel(9) > SPECTRUM_FLOOR, "double buffered bars");
+
+  hal_adc_samples.clear();
+  cube.suspend();                      // Nothing interrupts waitForShow() on the host
+  cube.doubleBuffer(false);
+  cube.resume();
+}
+#endif
+
+static int playRecording(
+  const char *path) {
+
+  if (! hal_adc_load(path)) {
+    perror(path);
+    return(1);
+  }
+
+  cube.spectrum(A4);
+
+  while (! hal_adc_samples.empty()) {
+    run(SPECTRUM_PERIOD);
+    for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) printf(" %3d", cube.spectrumLevel(band));
+    printf("\n");
+  }
+
+  return(0);
+}
+
+int main(int argc, char *argv[]) {
+  hal_reset();
+  cube.begin(-1);
+
+  if (argc > 1) return(playRecording(argv[1]));
+
+  checkADC();
+  checkBands();
+  checkDecay();
+  checkRecording();
+  checkSerial();
+#ifndef NO_DOUBLE_BUFFER
+  checkDoubleBuffered();
+#endif
+
+  return(checkPassed());
+}
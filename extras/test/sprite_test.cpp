@@ -0,0 +1,150 @@
+/*
+ * File:    sprite_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks sprite drawing, clipping, recolouring and collisions against a
+ * voxel by voxel reference.
+ */
+
+#include <stdio.h>
+
+#include "Cube.h"
+#include "check.h"
+
+extern byte cursorX, cursorY, cursorZ;           // graphics.h
+
+Cube cube;
+
+// 3x2x2, with transparent voxels at the corners of Z 1
+
+const byte block[] PROGMEM = {
+  3, 2, 2,
+  0x10, 0x00, 0x00,   0x20, 0x00, 0x00,   0x30, 0x00, 0x00,
+  0x00, 0x10, 0x00,   0x00, 0x20, 0x00,   0x00, 0x30, 0x00,
+  0x00, 0x00, 0x00,   0x00, 0x00, 0x40,   0x00, 0x00, 0x00,
+  0x50, 0x50, 0x00,   0x00, 0x50, 0x50,   0x00, 0x00, 0x00
+};
+
+// A single voxel, and a 1x1x3 column with a transparent middle
+
+const byte dot[] PROGMEM = { 1, 1, 1,  0xff, 0xff, 0xff };
+const byte column[] PROGMEM = { 1, 1, 3,  0x01, 0x02, 0x03,  0x00, 0x00, 0x00,  0x04, 0x05, 0x06 };
+
+static rgb_t spriteVoxel(const byte *sprite, int x, int y, int z) {
+  const byte *voxel = sprite + SPRITE_VOXELS + 3 * ((z * sprite[1] + y) * sprite[0] + x);
+  return(RGB(voxel[0], voxel[1], voxel[2]));
+}
+
+// Draws the sprite at every offset that overlaps the cube, and some that
+// don't, over a background, and checks every voxel
+
+static void checkBlit(const char *name, const byte *sprite, const rgb_t *recolor) {
+  rgb_t background = RGB(0x01, 0x01, 0x01);
+  unsigned int mismatches = 0;
+
+  for (int ox = -4;  ox <= CUBE_SIZE + 1;  ox ++) {
+    for (int oy = -3;  oy <= CUBE_SIZE;  oy ++) {
+      for (int oz = -3;  oz <= CUBE_SIZE;  oz ++) {
+        cube.all(background);
+        cube.set(0, 0, 0, background);
+        if (recolor) {
+          cube.spriteColor(sprite, ox, oy, oz, *recolor);
+        }
+        else {
+          cube.sprite(sprite, ox, oy, oz);
+        }
+
+        int lastX = -1, lastY = -1, lastZ = -1;
+
+        for (int z = 0;  z < CUBE_SIZE;  z ++) {
+          for (int y = 0;  y < CUBE_SIZE;  y ++) {
+            for (int x = 0;  x < CUBE_SIZE;  x ++) {
+              rgb_t expected = background;
+              int sx = x - ox, sy = y - oy, sz = z - oz;
+
+              if (sx >= 0  &&  sx < sprite[0]  &&  sy >= 0  &&  sy < sprite[1]  &&  sz >= 0  &&  sz < sprite[2]) {
+                rgb_t voxel = spriteVoxel(sprite, sx, sy, sz);
+                if (! same(voxel, BLACK)) {
+                  expected = recolor  ?  *recolor  :  voxel;
+                  lastX = x;  lastY = y;  lastZ = z;
+                }
+              }
+
+              if (! same(frameGet(led, x, y, z), expected)  &&  mismatches ++ < 4) {
+                printf("%s at %d %d %d: voxel %d %d %d differs\n", name, ox, oy, oz, x, y, z);
+              }
+            }
+          }
+        }
+
+        // The cursor is left at the last voxel drawn
+        if (lastX < 0) {
+          lastX = lastY = lastZ = 0;
+        }
+        if (cursorX != lastX  ||  cursorY != lastY  ||  cursorZ != lastZ) mismatches ++;
+      }
+    }
+  }
+
+  check(mismatches == 0, name);
+}
+
+// Collisions against a voxel by voxel check
+
+static void checkCollisions(void) {
+  const byte *sprites[] = { block, dot, column };
+  unsigned int mismatches = 0;
+
+  for (byte a = 0;  a < 3;  a ++) {
+    for (byte b = 0;  b < 3;  b ++) {
+      for (int dx = -4;  dx <= 4;  dx ++) {
+        for (int dy = -3;  dy <= 3;  dy ++) {
+          for (int dz = -4;  dz <= 4;  dz ++) {
+            const byte *sa = sprites[a], *sb = sprites[b];
+            bool expected = false;
+
+            for (int z = 0;  z < sa[2];  z ++) {
+              for (int y = 0;  y < sa[1];  y ++) {
+                for (int x = 0;  x < sa[0];  x ++) {
+                  int bx = x - dx, by = y - dy, bz = z - dz;
+                  if (bx < 0  ||  bx >= sb[0]  ||  by < 0  ||  by >= sb[1]  ||  bz < 0  ||  bz >= sb[2]) continue;
+                  if (! same(spriteVoxel(sa, x, y, z), BLACK)  &&  ! same(spriteVoxel(sb, bx, by, bz), BLACK)) expected = true;
+                }
+              }
+            }
+
+            // Offset by -2, so that some collisions are outside the cube
+            if (cube.spriteCollision(sa, -2, -2, -2, sb, dx - 2, dy - 2, dz - 2) != expected  &&  mismatches ++ < 4) {
+              printf("collision %d %d at %d %d %d differs\n", a, b, dx, dy, dz);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  check(mismatches == 0, "collisions");
+}
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+
+  checkBlit("sprite", block, NULL);
+  checkBlit("column", column, NULL);
+
+  rgb_t recolor = RGB(0x80, 0x00, 0x80);
+  checkBlit("recoloured sprite", block, & recolor);
+
+  // Another key colour
+  cube.all(BLACK);
+  cube.sprite(column, 0, 0, 0, RGB(0x01, 0x02, 0x03));
+  check(same(frameGet(led, 0, 0, 0), BLACK)  &&  same(frameGet(led, 0, 0, 1), BLACK)  &&
+        same(frameGet(led, 0, 0, 2), RGB(0x04, 0x05, 0x06)), "key colour");
+
+  checkCollisions();
+
+  return(checkPassed());
+}
@@ -0,0 +1,275 @@
+/*
+ * File:    text_test.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Checks text (see font.cpp) against a model of font4x4 and of where each
+ * face's columns are: text drawn on each face and around all four, clipping,
+ * the scroller at every tick, its loops, and the serial commands.
+ */
+
+#include <stdio.h>
+#include <vector>
+
+#include "Cube.h"
+#include "check.h"
+
+static const unsigned long TICK_CYCLES = F_CPU / 1000;   // Poll every 1 ms
+static const byte          LAST        = CUBE_SIZE - 1;
+
+Cube cube;
+
+typedef struct {
+  byte x, y;
+}
+  place_t;
+
+static void tick(void) {
+  hal_run(TICK_CYCLES);
+  cube.poll();
+}
+
+// The columns of the text, left to right, each bit 0 at the bottom
+
+static std::vector<byte> model(
+  const char *text) {
+
+  std::vector<byte> columns;
+
+  for (const char *character = text;  *character;  character ++) {
+    char glyph = toupper(*character);
+    if (glyph < ' '  ||  glyph > 'Z') glyph = '?';
+
+    const byte *data = font4x4 + FONT_GLYPHS + (glyph - ' ') * 4;
+    byte width = 2;
+    for (byte column = 0;  column < 4;  column ++) if (data[column]) width = column + 1;
+
+    columns.insert(columns.end(), data, data + width);
+    if (character[1]) columns.push_back(0);
+  }
+
+  return(columns);
+}
+
+// Where each column of the face is, walking around the cube anticlockwise
+// seen from above
+
+static std::vector<place_t> places(
+  byte face) {
+
+  std::vector<place_t> front, right, back, left, all;
+
+  for (byte step = 0;  step <= LAST;  step ++) {
+    front.push_back((place_t) { step, 0 });
+    right.push_back((place_t) { LAST, step });
+    back.push_back((place_t) { (byte) (LAST - step), LAST });
+    left.push_back((place_t) { 0, (byte) (LAST - step) });
+  }
+
+  switch (face) {
+    case FACE_FRONT: return(front);
+    case FACE_RIGHT: return(right);
+    case FACE_BACK:  return(back);
+    case FACE_LEFT:  return(left);
+  }
+
+  // Each corner once, as the end of one face and the start of the next
+  all.insert(all.end(), front.begin(), front.end() - 1);
+  all.insert(all.end(), right.begin(), right.end() - 1);
+  all.insert(all.end(), back.begin(),  back.end() - 1);
+  all.insert(all.end(), left.begin(),  left.end() - 1);
+  return(all);
+}
+
+// Voxels of the face that differ from the text starting at column
+
+static unsigned int mismatches(
+  frame_t    *frame,
+  const char *text,
+  byte        face,
+  int         column,
+  rgb_t       rgb,
+  rgb_t       background) {
+
+  std::vector<byte>    columns = model(text);
+  std::vector<place_t> face_   = places(face);
+  unsigned int wrong = 0;
+
+  for (int index = 0;  index < (int) face_.size();  index ++) {
+    int  offset = index - column;
+    byte bits = (offset >= 0  &&  offset < (int) columns.size())  ?  columns[offset]  :  0;
+
+    for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+      rgb_t expected = (z < 8  &&  (bits >> z) & 1)  ?  rgb  :  background;
+      if (! same(frameGet(frame, face_[index].x, face_[index].y, z), expected)) wrong ++;
+    }
+  }
+
+  return(wrong);
+}
+
+static void checkFont(void) {
+  check(font4x4[FONT_COLUMNS] == 4  &&  font4x4[FONT_ROWS] == 4, "font4x4 size");
+
+  bool rows = true;
+  for (unsigned int index = FONT_GLYPHS;  index < FONT_GLYPHS + ('Z' - ' ' + 1) * 4;  index ++) {
+    if (font4x4[index] > 0x0f) rows = false;
+  }
+  check(rows, "glyphs 4 rows high");
+
+  check(cube.textWidth("") == 0, "no width");
+  check(cube.textWidth(" ") == 2, "space");
+  check(cube.textWidth("AB") == (int) model("AB").size(), "width");
+  check(cube.textWidth("ab") == cube.textWidth("AB"), "lower case width");
+}
+
+static void checkFaces(void) {
+  for (byte face = FACE_FRONT;  face <= FACE_WRAP;  face ++) {
+    cube.all(GREEN);
+    int width = cube.text("!", face, 0, RED, BLUE);
+
+    check(width == 1, "glyph width");
+    check(mismatches(led, "!", face, 0, RED, BLUE) == 0, "glyph on the face");
+    check(same(frameGet(led, 1, 1, 1), GREEN), "inside untouched");
+  }
+
+  // The first column of each face, '!' is lit in rows 0, 2 and 3
+  const place_t corners[] = { { 0, 0 }, { LAST, 0 }, { LAST, LAST }, { 0, LAST } };
+
+  for (byte face = FACE_FRONT;  face <= FACE_LEFT;  face ++) {
+    cube.text("!", face, 0, RED, BLUE);
+    check(same(frameGet(led, corners[face].x, corners[face].y, 0), RED)   &&
+          same(frameGet(led, corners[face].x, corners[face].y, 1), BLUE)  &&
+          same(frameGet(led, corners[face].x, corners[face].y, 3), RED), "face corner");
+  }
+
+  // Clipped either side, lower case, characters not in the font
+  const char *text = "Hi~ 42";
+  const int   columns[] = { -5, -1, 1, CUBE_SIZE - 2, 4 * LAST - 3 };
+
+  for (byte face = FACE_FRONT;  face <= FACE_WRAP;  face ++) {
+    for (byte index = 0;  index < sizeof(columns) / sizeof(int);  index ++) {
+      cube.text(text, face, columns[index], WHITE, BLACK);
+      check(mismatches(led, text, face, columns[index], WHITE, BLACK) == 0, "clipped text");
+    }
+  }
+
+  check(cube.text("X", FACE_WRAP + 1, 0, RED) == 0, "no such face");
+}
+
+// Each tick, the text is where text() would draw it after the columns
+// scrolled so far
+
+static void checkScroll(
+  byte face) {
+
+  const char *text = "Hi 5";
+  int columns = places(face).size();
+  int steps   = model(text).size() + 1 + columns;     // Text, blank, gap
+  unsigned int wrong = 0;
+
+  cube.all(BLACK);
+  cube.set(1, 1, 1, GREEN);
+  cube.scroll(text, face, RED, 10, BLUE, 2);
+
+  check(cube.isScrolling(), "scrolling");
+  check(mismatches(led, text, face, columns - 1, RED, BLUE) == 0, "first column straight away");
+
+  check(same(frameGet(led, 1, 1, 1), GREEN), "only the face moves");
+
+  unsigned long start = millis();
+  int stepped = 1;
+
+  while (cube.isScrolling()  &&  millis() - start < 2000) {
+    tick();
+    stepped = 1 + (millis() - start) / 10;
+    if (stepped > steps) stepped -= steps;                // Second time
+
+    if (cube.isScrolling()  &&  mismatches(led, text, face, columns - stepped, RED, BLUE)) wrong ++;
+  }
+
+  check(wrong == 0, "scrolled text each tick");
+  check(! cube.isScrolling()  &&  millis() - start == (unsigned long) (2 * steps - 1) * 10, "two loops");
+  check(mismatches(led, "", face, 0, RED, BLUE) == 0, "scrolled off");
+
+  cube.scroll(text, face, RED, 10);
+  for (byte count = 0;  count < 20;  count ++) tick();
+  cube.scrollStop();
+  check(! cube.isScrolling(), "stop");
+}
+
+static void checkSerial(void) {
+  bytecode_t bytecode = {};
+
+  char text[] = "text 1 ff0000 Hi there";
+  check(parser(text, strlen(text), & bytecode) == 0, "text command");
+  check(mismatches(led, "HI THERE", FACE_RIGHT, 0, RED, BLACK) == 0, "serial text");
+
+  char badFace[] = "text 5 red x";
+  check(parser(badFace, strlen(badFace), & bytecode) != 0, "no such face");
+
+  char scroll[] = "scroll 4 blue 100 abc";
+  check(parser(scroll, strlen(scroll), & bytecode) == 0  &&  cube.isScrolling(), "scroll command");
+
+  char stop[] = "scroll";
+  check(parser(stop, strlen(stop), & bytecode) == 0  &&  ! cube.isScrolling(), "scroll stops");
+
+  char partial[] = "scroll 4 blue";
+  check(parser(partial, strlen(partial), & bytecode) != 0  &&  ! cube.isScrolling(), "scroll needs a period");
+
+  char glued[] = "scroll 4 blue 500abc";
+  check(parser(glued, strlen(glued), & bytecode) != 0  &&  ! cube.isScrolling(), "period needs a delimiter");
+
+  char huge[] = "scroll 4 blue 99999999999999999999 abc";
+  check(parser(huge, strlen(huge), & bytecode) != 0  &&  ! cube.isScrolling(), "period too long");
+}
+
+#ifndef NO_DOUBLE_BUFFER
+// Double buffered, each column is shown, and the last one stays
+
+static void checkDoubleBuffered(void) {
+  unsigned int wrong = 0;
+
+  cube.all(BLACK);
+  cube.doubleBuffer(true);
+  cube.scroll("T", FACE_FRONT, RED, 10, BLUE, 1);
+
+  unsigned long start = millis();
+
+  while (cube.isScrolling()) {
+    tick();
+    if ((millis() - start) % 10 == 9) {          // Swapped by the next column
+      int stepped = 1 + (millis() - start) / 10;
+      if (mismatches(ledDisplay, "T", FACE_FRONT, CUBE_SIZE - stepped, RED, BLUE)) wrong ++;
+    }
+  }
+
+  for (byte count = 0;  count < 10;  count ++) tick();
+
+  check(wrong == 0, "double buffered columns displayed");
+  check(mismatches(ledDisplay, "", FACE_FRONT, 0, RED, BLUE) == 0  &&
+        mismatches(led, "", FACE_FRONT, 0, RED, BLUE) == 0, "double buffered end");
+
+  cube.suspend();                  // Nothing interrupts waitForShow() on the host
+  cube.doubleBuffer(false);
+  cube.resume();
+}
+#endif
+
+int main(void) {
+  hal_reset();
+  cube.begin(-1);
+
+  checkFont();
+  checkFaces();
+  checkScroll(FACE_FRONT);
+  checkScroll(FACE_BACK);
+  checkScroll(FACE_WRAP);
+  checkSerial();
+#ifndef NO_DOUBLE_BUFFER
+  checkDoubleBuffered();
+#endif
+
+  return(checkPassed());
+}
@@ -0,0 +1,388 @@
+/*
+ * File:    font.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Text on the faces of the cube, see font.h for the font format.
+ *
+ * Text is drawn one column of voxels at a time, each column read straight
+ * from program memory.  cubeScrollPoll(), called by cubePoll(), scrolls text
+ * one column per period without redrawing it: only the voxels of the face
+ * (or of the ring around all four faces) are moved along, and only the
+ * column coming in is drawn.
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+// 4 x 4 voxels, 3 columns wide where that will do, ' ' to 'Z'
+
+const byte font4x4[] PROGMEM = {
+  4, 4, ' ', 'Z',
+  0x00, 0x00, 0x00, 0x00,   // ' '
+  0x0d, 0x00, 0x00, 0x00,   // '!'
+  0x0c, 0x00, 0x0c, 0x00,   // '"'
+  0x05, 0x0f, 0x05, 0x0f,   // '#'
+  0x05, 0x0f, 0x0a, 0x00,   // '$'
+  0x0b, 0x00, 0x0d, 0x00,   // '%'
+  0x05, 0x0b, 0x06, 0x00,   // '&'
+  0x0c, 0x00, 0x00, 0x00,   // '''
+  0x06, 0x09, 0x00, 0x00,   // '('
+  0x09, 0x06, 0x00, 0x00,   // ')'
+  0x0a, 0x04, 0x0a, 0x00,   // '*'
+  0x02, 0x07, 0x02, 0x00,   // '+'
+  0x01, 0x02, 0x00, 0x00,   // ','
+  0x02, 0x02, 0x02, 0x00,   // '-'
+  0x01, 0x00, 0x00, 0x00,   // '.'
+  0x01, 0x02, 0x0c, 0x00,   // '/'
+  0x0f, 0x09, 0x0f, 0x00,   // '0'
+  0x05, 0x0f, 0x01, 0x00,   // '1'
+  0x09, 0x0b, 0x05, 0x00,   // '2'
+  0x09, 0x0d, 0x0f, 0x00,   // '3'
+  0x0e, 0x02, 0x0f, 0x00,   // '4'
+  0x0d, 0x0d, 0x0a, 0x00,   // '5'
+  0x0f, 0x05, 0x07, 0x00,   // '6'
+  0x08, 0x0b, 0x0c, 0x00,   // '7'
+  0x0f, 0x0d, 0x0f, 0x00,   // '8'
+  0x0e, 0x0a, 0x0f, 0x00,   // '9'
+  0x05, 0x00, 0x00, 0x00,   // ':'
+  0x01, 0x04, 0x00, 0x00,   // ';'
+  0x04, 0x0a, 0x00, 0x00,   // '<'
+  0x05, 0x05, 0x05, 0x00,   // '='
+  0x0a, 0x04, 0x00, 0x00,   // '>'
+  0x08, 0x0b, 0x04, 0x00,   // '?'
+  0x0e, 0x09, 0x0d, 0x00,   // '@'
+  0x07, 0x0a, 0x07, 0x00,   // 'A'
+  0x0f, 0x0d, 0x07, 0x00,   // 'B'
+  0x0f, 0x09, 0x09, 0x00,   // 'C'
+  0x0f, 0x09, 0x06, 0x00,   // 'D'
+  0x0f, 0x0d, 0x09, 0x00,   // 'E'
+  0x0f, 0x0a, 0x08, 0x00,   // 'F'
+  0x0f, 0x09, 0x0b, 0x00,   // 'G'
+  0x0f, 0x04, 0x0f, 0x00,   // 'H'
+  0x09, 0x0f, 0x09, 0x00,   // 'I'
+  0x03, 0x01, 0x0f, 0x00,   // 'J'
+  0x0f, 0x06, 0x09, 0x00,   // 'K'
+  0x0f, 0x01, 0x01, 0x00,   // 'L'
+  0x0f, 0x04, 0x04, 0x0f,   // 'M'
+  0x0f, 0x04, 0x02, 0x0f,   // 'N'
+  0x0f, 0x09, 0x0f, 0x00,   // 'O'
+  0x0f, 0x0a, 0x0e, 0x00,   // 'P'
+  0x0e, 0x0a, 0x0e, 0x01,   // 'Q'
+  0x0f, 0x0a, 0x0d, 0x00,   // 'R'
+  0x05, 0x09, 0x0a, 0x00,   // 'S'
+  0x08, 0x0f, 0x08, 0x00,   // 'T'
+  0x0f, 0x01, 0x0f, 0x00,   // 'U'
+  0x0e, 0x01, 0x0e, 0x00,   // 'V'
+  0x0f, 0x02, 0x02, 0x0f,   // 'W'
+  0x09, 0x06, 0x09, 0x00,   // 'X'
+  0x0c, 0x03, 0x0c, 0x00,   // 'Y'
+  0x0b, 0x09, 0x0d, 0x00,   // 'Z'
+};
+
+static const byte *textFont = font4x4;
+
+static char          scrollText[SCROLL_LENGTH + 1];
+static byte          scrollIndex;                 // Character coming in
+static byte          scrollColumn;                // ... its column, or of the gap after the text
+static byte          scrollFace;
+static rgb_t         scrollColor;
+static rgb_t         scrollBackground;
+static unsigned int  scrollPeriod;                // Milliseconds per column
+static unsigned long scrollDue;                   // millis() for the next column
+static byte          scrollLoops;                 // Still to scroll, 0 is forever
+static bool          scrolling    = false;
+static bool          scrollStart  = false;        // Face still to clear
+
+static inline byte fontByte(
+  byte offset) {
+
+  return(pgm_read_byte(textFont + offset));
+}
+
+// The glyph for the character, see font.h
+
+static const byte *fontGlyph(
+  char character) {
+
+  byte first = fontByte(FONT_FIRST);
+  byte last  = fontByte(FONT_LAST);
+
+  if (character >= 'a'  &&  character <= 'z'  &&  last < 'a') character -= 'a' - 'A';
+
+  if ((byte) character < first  ||  (byte) character > last) {
+    character = ('?' >= first  &&  '?' <= last)  ?  '?'  :  first;
+  }
+
+  return(textFont + FONT_GLYPHS + ((byte) character - first) * fontByte(FONT_COLUMNS));
+}
+
+static byte fontWidth(
+  const byte *glyph) {
+
+  byte columns = fontByte(FONT_COLUMNS);
+
+  for (byte column = columns;  column > 0;  column --) {
+    if (pgm_read_byte(glyph + column - 1)) return(column);
+  }
+
+  return((columns + 1) / 2);                      // Blank
+}
+
+static inline int textColumns(
+  byte face) {
+
+  return((face == FACE_WRAP)  ?  4 * (CUBE_SIZE - 1)  :  CUBE_SIZE);
+}
+
+static void textPosition(
+  byte  face,
+  int   column,
+  byte *x,
+  byte *y) {
+
+  const byte last = CUBE_SIZE - 1;
+
+  if (face == FACE_WRAP) {
+    face   = column / last;
+    column = column % last;
+  }
+
+  switch (face) {
+    case FACE_FRONT: *x = column;         *y = 0;              break;
+    case FACE_RIGHT: *x = last;           *y = column;         break;
+    case FACE_BACK:  *x = last - column;  *y = last;           break;
+    default:         *x = 0;              *y = last - column;  break;
+  }
+}
+
+// Draws one column, bits from the bottom up, clipped to the face
+
+static void textPut(
+  byte  face,
+  int   column,
+  byte  bits,
+  rgb_t rgb,
+  rgb_t background) {
+
+  if (column < 0  ||  column >= textColumns(face)) return;
+
+  byte x, y;
+  textPosition(face, column, & x, & y);
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    framePut(led, x, y, z, (bits & 1)  ?  rgb  :  background);
+    ledDrawDirty[z] = LED_DIRTY_PLANE;
+    bits >>= 1;
+  }
+}
+
+void Cube::font(
+  const byte *font) {
+
+  cubeFont(font);
+}
+
+void cubeFont(
+  const byte *font) {
+
+  textFont = font;
+}
+
+int Cube::text(
+  const char *text,
+  byte        face,
+  int         column,
+  rgb_t       rgb,
+  rgb_t       background) {
+
+  return(cubeText(text, face, column, rgb, background));
+}
+
+// Fills the face (or all four) with the background, then draws the text
+// starting at column, which may be off the face.  Returns its width.
+
+int cubeText(
+  const char *text,
+  byte        face,
+  int         column,
+  rgb_t       rgb,
+  rgb_t       background) {
+
+  if (face > FACE_WRAP) return(0);
+
+  for (int index = 0;  index < textColumns(face);  index ++) textPut(face, index, 0, rgb, background);
+
+  int start = column;
+
+  while (*text) {
+    const byte *glyph = fontGlyph(*text ++);
+    byte width = fontWidth(glyph);
+
+    for (byte index = 0;  index < width;  index ++) {
+      textPut(face, column ++, pgm_read_byte(glyph + index), rgb, background);
+    }
+
+    if (*text) column ++;                         // Blank between characters
+  }
+
+  return(column - start);
+}
+
+int Cube::textWidth(
+  const char *text) {
+
+  return(cubeTextWidth(text));
+}
+
+// Columns, including those between characters
+
+int cubeTextWidth(
+  const char *text) {
+
+  int width = 0;
+
+  while (*text) {
+    width += fontWidth(fontGlyph(*text ++));
+    if (*text) width ++;
+  }
+
+  return(width);
+}
+
+// The column of the text coming in next, then the blank gap after it, as
+// wide as the face, so that the text has gone before it comes round again.
+// True at the end of the gap.
+
+static bool scrollNext(
+  byte *bits) {
+
+  *bits = 0;
+
+  if (scrollText[scrollIndex]) {
+    const byte *glyph = fontGlyph(scrollText[scrollIndex]);
+
+    if (scrollColumn < fontWidth(glyph)) {
+      *bits = pgm_read_byte(glyph + scrollColumn ++);
+    }
+    else {
+      scrollIndex ++;                             // Blank after each character
+      scrollColumn = 0;
+    }
+
+    return(false);
+  }
+
+  if (++ scrollColumn < textColumns(scrollFace)) return(false);
+
+  scrollIndex  = 0;
+  scrollColumn = 0;
+  return(true);
+}
+
+static void scrollStep(void) {
+  if (scrollStart) {
+    cubeText("", scrollFace, 0, scrollColor, scrollBackground);
+    scrollStart = false;
+  }
+
+  byte bits;
+  bool end = scrollNext(& bits);
+  int  last = textColumns(scrollFace) - 1;
+
+  // Only the face's (or the ring's) columns move, the rest of the cube stays
+  for (int column = 0;  column < last;  column ++) {
+    byte x1, y1, x2, y2;
+    textPosition(scrollFace, column, & x1, & y1);
+    textPosition(scrollFace, column + 1, & x2, & y2);
+
+    for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+      framePutVoxel(led, x1, y1, z, frameGetVoxel(led, x2, y2, z));
+    }
+  }
+
+  textPut(scrollFace, last, bits, scrollColor, scrollBackground);
+
+  if (end) {
+    if (scrollLoops == 1) scrolling = false;
+    if (scrollLoops > 1) scrollLoops --;
+  }
+}
+
+void Cube::scroll(
+  const char   *text,
+  byte          face,
+  rgb_t         rgb,
+  unsigned int  period,
+  rgb_t         background,
+  byte          loops) {
+
+  cubeScroll(text, face, rgb, period, background, loops);
+}
+
+// Scrolls a copy of the text (up to SCROLL_LENGTH characters) across the
+// face, or around all four, one column every period milliseconds, loops
+// times (0 is forever), starting straight away.
+
+void cubeScroll(
+  const char   *text,
+  byte          face,
+  rgb_t         rgb,
+  unsigned int  period,
+  rgb_t         background,
+  byte          loops) {
+
+  if (face > FACE_WRAP) return;
+
+  strncpy(scrollText, text, SCROLL_LENGTH);
+  scrollText[SCROLL_LENGTH] = '\0';
+
+  scrollIndex      = 0;
+  scrollColumn     = 0;
+  scrollFace       = face;
+  scrollColor      = rgb;
+  scrollBackground = background;
+  scrollPeriod     = period;
+  scrollDue        = millis();
+  scrollLoops      = loops;
+  scrolling        = true;
+  scrollStart      = true;
+
+  cubeScrollPoll();
+}
+
+void Cube::scrollStop() {
+  cubeScrollStop();
+}
+
+// The text stays where it is
+
+void cubeScrollStop(void) {
+  scrolling = false;
+}
+
+boolean Cube::isScrolling() {
+  return(cubeIsScrolling());
+}
+
+boolean cubeIsScrolling(void) {
+  return(scrolling);
+}
+
+void cubeScrollPoll(void) {
+  if (! scrolling  ||  ! cubeFrameFree()) return;
+
+  unsigned long now = millis();
+  if ((long) (now - scrollDue) < 0) return;
+
+  scrollStep();
+  cubeFrameDrawn();
+
+  // Columns keep to the period, unless poll() is called too late
+  scrollDue += scrollPeriod;
+  if ((long) (now - scrollDue) > 0) scrollDue = now;
+}
+#endif
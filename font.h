@@ -0,0 +1,48 @@
+/*
+ * File:    font.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Fonts, stored in program memory, and text drawn on the faces of the cube
+ * (see Cube::text() and Cube::scroll()).
+ *
+ * A font is a byte array: the columns and rows (up to 8) of each glyph, the
+ * first and last characters, then each glyph's columns, left to right, one
+ * byte each with bit 0 the bottom row.  Glyphs are drawn as wide as their
+ * last lit column, with a blank column between characters, and blank glyphs
+ * (e.g. space) are half the font's columns wide.  Lower case letters use the
+ * upper case glyphs when the font has none, other characters the font lacks
+ * are drawn as '?'.
+ */
+
+#ifndef FONT_h
+#define FONT_h
+
+static const byte FONT_COLUMNS = 0;                 // Header byte offsets
+static const byte FONT_ROWS    = 1;
+static const byte FONT_FIRST   = 2;
+static const byte FONT_LAST    = 3;
+static const byte FONT_GLYPHS  = 4;
+
+// Faces, seen from outside the cube, with text running left to right
+
+static const byte FACE_FRONT = 0;   // Y 0, along X
+static const byte FACE_RIGHT = 1;   // X CUBE_SIZE - 1, along Y
+static const byte FACE_BACK  = 2;   // Y CUBE_SIZE - 1, back along X
+static const byte FACE_LEFT  = 3;   // X 0, back along Y
+static const byte FACE_WRAP  = 4;   // Around all four, starting at the front
+
+static const byte SCROLL_LENGTH = 32;               // Characters kept by scroll()
+
+extern const byte font4x4[] PROGMEM;                // ' ' to 'Z'
+
+extern void cubeFont(const byte *font);
+extern int cubeText(const char *text, byte face, int column, rgb_t rgb, rgb_t background = BLACK);
+extern int cubeTextWidth(const char *text);
+extern void cubeScroll(const char *text, byte face, rgb_t rgb, unsigned int period, rgb_t background = BLACK, byte loops = 0);
+extern void cubeScrollStop(void);
+extern boolean cubeIsScrolling(void);
+extern void cubeScrollPoll(void);
+
+#endif
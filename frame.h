@@ -0,0 +1,389 @@
+/*
+ * File:    frame.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Frame buffer layout and voxel accessors.
+ *
+ * All code that reads or writes a frame buffer should use these accessors,
+ * so that the memory layout can be changed at compile time (CUBE_LAYOUT_PLANAR,
+ * CUBE_PALETTE) without changing the graphics code or sketches.
+ */
+
+#ifndef FRAME_h
+#define FRAME_h
+
+static const byte COLOR_PLANES = 3;
+static const byte PLANE_VOXELS = CUBE_SIZE * CUBE_SIZE;
+
+#if defined(CUBE_PALETTE)
+
+// [x][y][z] palette indexes (see palette.cpp), two to a byte, lower voxel in
+// the low nibble, when there are 16 or fewer palette colors.  Colors drawn
+// are stored as the index of the nearest palette color, colors read back
+// come from the palette, so the refresh interrupt expands them through the
+// palette as it serializes each slice.
+
+extern rgb_t framePalette[CUBE_PALETTE];
+extern byte  framePaletteIndex(rgb_t rgb);
+
+#if CUBE_PALETTE <= 16
+typedef byte frame_t[CUBE_SIZE * PLANE_VOXELS / 2];
+#else
+typedef byte frame_t[CUBE_SIZE * PLANE_VOXELS];
+#endif
+
+static inline unsigned int frameVoxel(
+  byte x, byte y, byte z) {
+
+  return(((unsigned int) x * CUBE_SIZE + y) * CUBE_SIZE + z);
+}
+
+static inline byte frameGetIndex(
+  frame_t *frame, byte x, byte y, byte z) {
+
+  unsigned int voxel = frameVoxel(x, y, z);
+#if CUBE_PALETTE <= 16
+  byte pair = (*frame)[voxel >> 1];
+  return((voxel & 1)  ?  pair >> 4  :  pair & 0x0f);
+#else
+  return((*frame)[voxel]);
+#endif
+}
+
+static inline void framePutIndex(
+  frame_t *frame, byte x, byte y, byte z, byte index) {
+
+  unsigned int voxel = frameVoxel(x, y, z);
+#if CUBE_PALETTE <= 16
+  byte *pair = & (*frame)[voxel >> 1];
+  *pair = (voxel & 1)  ?  (*pair & 0x0f) | (index << 4)  :  (*pair & 0xf0) | index;
+#else
+  (*frame)[voxel] = index;
+#endif
+}
+
+static inline byte frameGetColor(
+  frame_t *frame, byte x, byte y, byte z, byte color) {
+
+  return(framePalette[frameGetIndex(frame, x, y, z)].color[color]);
+}
+
+static inline rgb_t frameGet(
+  frame_t *frame, byte x, byte y, byte z) {
+
+  return(framePalette[frameGetIndex(frame, x, y, z)]);
+}
+
+static inline void framePut(
+  frame_t *frame, byte x, byte y, byte z, rgb_t rgb) {
+
+  framePutIndex(frame, x, y, z, framePaletteIndex(rgb));
+}
+
+// Block kernels.  Whole X planes are contiguous, as are the rows along Z,
+// and both start on a byte.
+
+static inline void frameFill(
+  frame_t *frame, rgb_t rgb) {
+
+  byte index = framePaletteIndex(rgb);
+#if CUBE_PALETTE <= 16
+  index |= index << 4;
+#endif
+  memset(*frame, index, sizeof(frame_t));
+}
+
+static inline void frameFillPlane(
+  frame_t *frame, byte axis, byte position, rgb_t rgb) {
+
+  byte index = framePaletteIndex(rgb);
+
+  for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+    for (byte j = 0;  j < CUBE_SIZE;  j ++) {
+      if (axis == X) framePutIndex(frame, position, i, j, index);
+      if (axis == Y) framePutIndex(frame, i, position, j, index);
+      if (axis == Z) framePutIndex(frame, i, j, position, index);
+    }
+  }
+}
+
+static inline void frameCopyPlane(
+  frame_t *frame, byte axis, byte position, byte destination) {
+
+  if (axis == X) {
+    const unsigned int bytes = sizeof(frame_t) / CUBE_SIZE;
+    memcpy(*frame + destination * bytes, *frame + position * bytes, bytes);
+    return;
+  }
+
+  for (byte i = 0;  i < CUBE_SIZE;  i ++) {
+    for (byte j = 0;  j < CUBE_SIZE;  j ++) {
+      if (axis == Y) framePutIndex(frame, i, destination, j, frameGetIndex(frame, i, position, j));
+      if (axis == Z) framePutIndex(frame, i, j, destination, frameGetIndex(frame, i, j, position));
+    }
+  }
+}
+
+/* Move every voxel one place along the axis, in the given direction ('+' or
+ * '-').  Along X and Y that is a single memmove(), along Z with 4 bit
+ * indexes every byte takes a nibble from its neighbour.  Only the plane left
+ * behind needs filling afterwards.
+ */
+static inline void frameShift(
+  frame_t *frame, byte axis, byte direction) {
+
+  byte *bytes = *frame;
+  const unsigned int stride[3] = { sizeof(frame_t) / CUBE_SIZE, sizeof(frame_t) / PLANE_VOXELS, 1 };
+
+#if CUBE_PALETTE <= 16
+  if (axis == Z) {
+    if (direction == '+') {
+      for (unsigned int index = sizeof(frame_t) - 1;  index > 0;  index --) {
+        bytes[index] = (bytes[index] << 4) | (bytes[index - 1] >> 4);
+      }
+      bytes[0] <<= 4;
+    }
+    else {
+      for (unsigned int index = 0;  index < sizeof(frame_t) - 1;  index ++) {
+        bytes[index] = (bytes[index] >> 4) | (bytes[index + 1] << 4);
+      }
+      bytes[sizeof(frame_t) - 1] >>= 4;
+    }
+    return;
+  }
+#endif
+
+  if (direction == '+') {
+    memmove(bytes + stride[axis], bytes, sizeof(frame_t) - stride[axis]);
+  }
+  else {
+    memmove(bytes, bytes + stride[axis], sizeof(frame_t) - stride[axis]);
+  }
+}
+
+#elif defined(CUBE_LAYOUT_PLANAR)
+
+// [z][color][y * CUBE_SIZE + x], each color plane of each Z plane is stored
+// contiguously, in the same order that the LED drivers are loaded.
+
+typedef byte frame_t[CUBE_SIZE][COLOR_PLANES][PLANE_VOXELS];
+
+static inline byte frameGetColor(
+  frame_t *frame, byte x, byte y, byte z, byte color) {
+
+  return((*frame)[z][color][y * CUBE_SIZE + x]);
+}
+
+static inline rgb_t frameGet(
+  frame_t *frame, byte x, byte y, byte z) {
+
+  byte voxel = y * CUBE_SIZE + x;
+  return(RGB((*frame)[z][COLOR_PLANE_RED][voxel], (*frame)[z][COLOR_PLANE_GREEN][voxel], (*frame)[z][COLOR_PLANE_BLUE][voxel]));
+}
+
+static inline void framePut(
+  frame_t *frame, byte x, byte y, byte z, rgb_t rgb) {
+
+  byte voxel = y * CUBE_SIZE + x;
+  (*frame)[z][COLOR_PLANE_RED][voxel]   = rgb.color[COLOR_PLANE_RED];
+  (*frame)[z][COLOR_PLANE_GREEN][voxel] = rgb.color[COLOR_PLANE_GREEN];
+  (*frame)[z][COLOR_PLANE_BLUE][voxel]  = rgb.color[COLOR_PLANE_BLUE];
+}
+
+
+// Block kernels, on whole planes of one axis at a time.  In this layout rows
+// along X are contiguous, as are whole Z planes.
+
+static inline void frameFill(
+  frame_t *frame, rgb_t rgb) {
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+      memset((*frame)[z][color], rgb.color[color], PLANE_VOXELS);
+    }
+  }
+}
+
+static inline void frameFillPlane(
+  frame_t *frame, byte axis, byte position, rgb_t rgb) {
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    if (axis == Z  &&  z != position) continue;
+
+    for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+      byte *plane = (*frame)[z][color];
+
+      if (axis == Z) {
+        memset(plane, rgb.color[color], PLANE_VOXELS);
+      }
+      else if (axis == Y) {
+        memset(plane + position * CUBE_SIZE, rgb.color[color], CUBE_SIZE);
+      }
+      else {
+        for (byte voxel = position;  voxel < PLANE_VOXELS;  voxel += CUBE_SIZE) {
+          plane[voxel] = rgb.color[color];
+        }
+      }
+    }
+  }
+}
+
+static inline void frameCopyPlane(
+  frame_t *frame, byte axis, byte position, byte destination) {
+
+  if (axis == Z) {
+    memcpy((*frame)[destination], (*frame)[position], sizeof((*frame)[0]));
+    return;
+  }
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+      byte *plane = (*frame)[z][color];
+
+      if (axis == Y) {
+        memcpy(plane + destination * CUBE_SIZE, plane + position * CUBE_SIZE, CUBE_SIZE);
+      }
+      else {
+        for (byte row = 0;  row < PLANE_VOXELS;  row += CUBE_SIZE) {
+          plane[row + destination] = plane[row + position];
+        }
+      }
+    }
+  }
+}
+
+// Bytes between neighbouring voxels along each axis
+static const unsigned int FRAME_STRIDE[3] = { 1, CUBE_SIZE, COLOR_PLANES * PLANE_VOXELS };
+
+#else
+
+// [x][y][z].color[], the original layout.
+
+typedef rgb_t frame_t[CUBE_SIZE][CUBE_SIZE][CUBE_SIZE];
+
+static inline byte frameGetColor(
+  frame_t *frame, byte x, byte y, byte z, byte color) {
+
+  return((*frame)[x][y][z].color[color]);
+}
+
+static inline rgb_t frameGet(
+  frame_t *frame, byte x, byte y, byte z) {
+
+  return((*frame)[x][y][z]);
+}
+
+static inline void framePut(
+  frame_t *frame, byte x, byte y, byte z, rgb_t rgb) {
+
+  (*frame)[x][y][z] = rgb;
+}
+
+// Block kernels, on whole planes of one axis at a time.  In this layout
+// columns along Z are contiguous, as are whole X planes.
+
+static inline void frameFill(
+  frame_t *frame, rgb_t rgb) {
+
+  rgb_t *voxel = (*frame)[0][0];
+  for (unsigned int index = 0;  index < CUBE_SIZE * PLANE_VOXELS;  index ++) voxel[index] = rgb;
+}
+
+static inline void frameFillPlane(
+  frame_t *frame, byte axis, byte position, rgb_t rgb) {
+
+  if (axis == X) {
+    rgb_t *voxel = (*frame)[position][0];
+    for (byte index = 0;  index < PLANE_VOXELS;  index ++) voxel[index] = rgb;
+    return;
+  }
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    if (axis == Y) {
+      rgb_t *voxel = (*frame)[x][position];
+      for (byte z = 0;  z < CUBE_SIZE;  z ++) voxel[z] = rgb;
+    }
+    else {
+      for (byte y = 0;  y < CUBE_SIZE;  y ++) (*frame)[x][y][position] = rgb;
+    }
+  }
+}
+
+static inline void frameCopyPlane(
+  frame_t *frame, byte axis, byte position, byte destination) {
+
+  if (axis == X) {
+    memcpy((*frame)[destination], (*frame)[position], sizeof((*frame)[0]));
+    return;
+  }
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    if (axis == Y) {
+      memcpy((*frame)[x][destination], (*frame)[x][position], sizeof((*frame)[0][0]));
+    }
+    else {
+      for (byte y = 0;  y < CUBE_SIZE;  y ++) (*frame)[x][y][destination] = (*frame)[x][y][position];
+    }
+  }
+}
+
+// Bytes between neighbouring voxels along each axis
+static const unsigned int FRAME_STRIDE[3] = { PLANE_VOXELS * sizeof(rgb_t), CUBE_SIZE * sizeof(rgb_t), sizeof(rgb_t) };
+
+#endif
+
+// A voxel as stored, for code that only moves voxels around, so that with
+// CUBE_PALETTE they keep their palette index
+
+#ifdef CUBE_PALETTE
+typedef byte voxel_t;
+
+static inline voxel_t frameGetVoxel(
+  frame_t *frame, byte x, byte y, byte z) {
+
+  return(frameGetIndex(frame, x, y, z));
+}
+
+static inline void framePutVoxel(
+  frame_t *frame, byte x, byte y, byte z, voxel_t voxel) {
+
+  framePutIndex(frame, x, y, z, voxel);
+}
+#else
+typedef rgb_t voxel_t;
+
+static inline voxel_t frameGetVoxel(
+  frame_t *frame, byte x, byte y, byte z) {
+
+  return(frameGet(frame, x, y, z));
+}
+
+static inline void framePutVoxel(
+  frame_t *frame, byte x, byte y, byte z, voxel_t voxel) {
+
+  framePut(frame, x, y, z, voxel);
+}
+
+/* Move every voxel one place along the axis, in the given direction ('+' or
+ * '-') with a single memmove().  Voxels are at a fixed stride along each
+ * axis, so only the plane left behind, which ends up holding other voxels,
+ * needs filling afterwards.
+ */
+static inline void frameShift(
+  frame_t *frame, byte axis, byte direction) {
+
+  byte *bytes = (byte *) *frame;
+  unsigned int stride = FRAME_STRIDE[axis];
+
+  if (direction == '+') {
+    memmove(bytes + stride, bytes, sizeof(frame_t) - stride);
+  }
+  else {
+    memmove(bytes, bytes + stride, sizeof(frame_t) - stride);
+  }
+}
+#endif
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * File:    gamma.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Color gamma correction maps, 8 bit color value to MY9262 16 bit grayscale.
+ * Only included by Cube.cpp when CUBE_GAMMA is defined.
+ *
+ * Generated with: round(65535 * scale * pow(value / 255.0, gamma))
+ * - See post #37 http://www.microchip.com/forums/m479196-p2.aspx
+ * - See neuroelec.com/2011/04/led-brightness-to-your-eye-gamma-correction-no
+ */
+
+#ifndef GAMMA_h
+#define GAMMA_h
+
+#include <avr/pgmspace.h>
+
+#ifndef CUBE_GAMMA_PER_CHANNEL
+
+// gamma = 2.2, scale = 1.0
+const unsigned int gammaMap[256] PROGMEM = {
+  0x0000, 0x0000, 0x0002, 0x0004, 0x0007, 0x000b, 0x0011, 0x0018,
+  0x0020, 0x002a, 0x0035, 0x0041, 0x004f, 0x005e, 0x006f, 0x0081,
+  0x0094, 0x00a9, 0x00c0, 0x00d8, 0x00f2, 0x010e, 0x012b, 0x014a,
+  0x016a, 0x018c, 0x01b0, 0x01d5, 0x01fc, 0x0225, 0x024f, 0x027b,
+  0x02a9, 0x02d9, 0x030b, 0x033e, 0x0373, 0x03aa, 0x03e3, 0x041d,
+  0x0459, 0x0497, 0x04d7, 0x0519, 0x055d, 0x05a3, 0x05ea, 0x0633,
+  0x067f, 0x06cc, 0x071b, 0x076c, 0x07bf, 0x0814, 0x086b, 0x08c3,
+  0x091e, 0x097b, 0x09d9, 0x0a3a, 0x0a9d, 0x0b01, 0x0b68, 0x0bd0,
+  0x0c3b, 0x0ca8, 0x0d16, 0x0d87, 0x0dfa, 0x0e6e, 0x0ee5, 0x0f5e,
+  0x0fd9, 0x1056, 0x10d5, 0x1156, 0x11da, 0x125f, 0x12e6, 0x1370,
+  0x13fb, 0x1489, 0x1519, 0x15ab, 0x163f, 0x16d5, 0x176e, 0x1808,
+  0x18a5, 0x1944, 0x19e5, 0x1a88, 0x1b2d, 0x1bd4, 0x1c7e, 0x1d2a,
+  0x1dd8, 0x1e88, 0x1f3a, 0x1fef, 0x20a6, 0x215f, 0x221a, 0x22d7,
+  0x2397, 0x2459, 0x251d, 0x25e3, 0x26ac, 0x2776, 0x2843, 0x2913,
+  0x29e4, 0x2ab8, 0x2b8e, 0x2c66, 0x2d41, 0x2e1e, 0x2efd, 0x2fde,
+  0x30c2, 0x31a8, 0x3290, 0x337b, 0x3468, 0x3557, 0x3648, 0x373c,
+  0x3832, 0x392b, 0x3a25, 0x3b22, 0x3c22, 0x3d24, 0x3e28, 0x3f2e,
+  0x4037, 0x4142, 0x424f, 0x435f, 0x4471, 0x4586, 0x469d, 0x47b6,
+  0x48d2, 0x49f0, 0x4b10, 0x4c33, 0x4d58, 0x4e7f, 0x4fa9, 0x50d6,
+  0x5204, 0x5335, 0x5469, 0x559f, 0x56d7, 0x5812, 0x594f, 0x5a8e,
+  0x5bd0, 0x5d15, 0x5e5c, 0x5fa5, 0x60f1, 0x623f, 0x638f, 0x64e2,
+  0x6638, 0x6790, 0x68ea, 0x6a47, 0x6ba6, 0x6d08, 0x6e6c, 0x6fd3,
+  0x713c, 0x72a7, 0x7415, 0x7586, 0x76f9, 0x786e, 0x79e6, 0x7b61,
+  0x7cde, 0x7e5d, 0x7fdf, 0x8164, 0x82ea, 0x8474, 0x8600, 0x878e,
+  0x891f, 0x8ab3, 0x8c49, 0x8de1, 0x8f7c, 0x911a, 0x92ba, 0x945d,
+  0x9602, 0x97a9, 0x9954, 0x9b00, 0x9cb0, 0x9e62, 0xa016, 0xa1cd,
+  0xa386, 0xa542, 0xa701, 0xa8c2, 0xaa86, 0xac4c, 0xae15, 0xafe1,
+  0xb1af, 0xb37f, 0xb552, 0xb728, 0xb900, 0xbadb, 0xbcb9, 0xbe99,
+  0xc07b, 0xc261, 0xc449, 0xc633, 0xc820, 0xca10, 0xcc02, 0xcdf7,
+  0xcfee, 0xd1e8, 0xd3e5, 0xd5e4, 0xd7e6, 0xd9eb, 0xdbf2, 0xddfc,
+  0xe008, 0xe217, 0xe429, 0xe63d, 0xe854, 0xea6e, 0xec8a, 0xeea9,
+  0xf0ca, 0xf2ee, 0xf515, 0xf73f, 0xf96b, 0xfb9a, 0xfdcb, 0xffff
+};
+
+#define GAMMA_MAP(color) gammaMap
+
+#else
+
+// Red:   gamma = 2.2, scale = 1.0
+const unsigned int gammaMapRed[256] PROGMEM = {
+  0x0000, 0x0000, 0x0002, 0x0004, 0x0007, 0x000b, 0x0011, 0x0018,
+  0x0020, 0x002a, 0x0035, 0x0041, 0x004f, 0x005e, 0x006f, 0x0081,
+  0x0094, 0x00a9, 0x00c0, 0x00d8, 0x00f2, 0x010e, 0x012b, 0x014a,
+  0x016a, 0x018c, 0x01b0, 0x01d5, 0x01fc, 0x0225, 0x024f, 0x027b,
+  0x02a9, 0x02d9, 0x030b, 0x033e, 0x0373, 0x03aa, 0x03e3, 0x041d,
+  0x0459, 0x0497, 0x04d7, 0x0519, 0x055d, 0x05a3, 0x05ea, 0x0633,
+  0x067f, 0x06cc, 0x071b, 0x076c, 0x07bf, 0x0814, 0x086b, 0x08c3,
+  0x091e, 0x097b, 0x09d9, 0x0a3a, 0x0a9d, 0x0b01, 0x0b68, 0x0bd0,
+  0x0c3b, 0x0ca8, 0x0d16, 0x0d87, 0x0dfa, 0x0e6e, 0x0ee5, 0x0f5e,
+  0x0fd9, 0x1056, 0x10d5, 0x1156, 0x11da, 0x125f, 0x12e6, 0x1370,
+  0x13fb, 0x1489, 0x1519, 0x15ab, 0x163f, 0x16d5, 0x176e, 0x1808,
+  0x18a5, 0x1944, 0x19e5, 0x1a88, 0x1b2d, 0x1bd4, 0x1c7e, 0x1d2a,
+  0x1dd8, 0x1e88, 0x1f3a, 0x1fef, 0x20a6, 0x215f, 0x221a, 0x22d7,
+  0x2397, 0x2459, 0x251d, 0x25e3, 0x26ac, 0x2776, 0x2843, 0x2913,
+  0x29e4, 0x2ab8, 0x2b8e, 0x2c66, 0x2d41, 0x2e1e, 0x2efd, 0x2fde,
+  0x30c2, 0x31a8, 0x3290, 0x337b, 0x3468, 0x3557, 0x3648, 0x373c,
+  0x3832, 0x392b, 0x3a25, 0x3b22, 0x3c22, 0x3d24, 0x3e28, 0x3f2e,
+  0x4037, 0x4142, 0x424f, 0x435f, 0x4471, 0x4586, 0x469d, 0x47b6,
+  0x48d2, 0x49f0, 0x4b10, 0x4c33, 0x4d58, 0x4e7f, 0x4fa9, 0x50d6,
+  0x5204, 0x5335, 0x5469, 0x559f, 0x56d7, 0x5812, 0x594f, 0x5a8e,
+  0x5bd0, 0x5d15, 0x5e5c, 0x5fa5, 0x60f1, 0x623f, 0x638f, 0x64e2,
+  0x6638, 0x6790, 0x68ea, 0x6a47, 0x6ba6, 0x6d08, 0x6e6c, 0x6fd3,
+  0x713c, 0x72a7, 0x7415, 0x7586, 0x76f9, 0x786e, 0x79e6, 0x7b61,
+  0x7cde, 0x7e5d, 0x7fdf, 0x8164, 0x82ea, 0x8474, 0x8600, 0x878e,
+  0x891f, 0x8ab3, 0x8c49, 0x8de1, 0x8f7c, 0x911a, 0x92ba, 0x945d,
+  0x9602, 0x97a9, 0x9954, 0x9b00, 0x9cb0, 0x9e62, 0xa016, 0xa1cd,
+  0xa386, 0xa542, 0xa701, 0xa8c2, 0xaa86, 0xac4c, 0xae15, 0xafe1,
+  0xb1af, 0xb37f, 0xb552, 0xb728, 0xb900, 0xbadb, 0xbcb9, 0xbe99,
+  0xc07b, 0xc261, 0xc449, 0xc633, 0xc820, 0xca10, 0xcc02, 0xcdf7,
+  0xcfee, 0xd1e8, 0xd3e5, 0xd5e4, 0xd7e6, 0xd9eb, 0xdbf2, 0xddfc,
+  0xe008, 0xe217, 0xe429, 0xe63d, 0xe854, 0xea6e, 0xec8a, 0xeea9,
+  0xf0ca, 0xf2ee, 0xf515, 0xf73f, 0xf96b, 0xfb9a, 0xfdcb, 0xffff
+};
+
+// Green: gamma = 2.4, scale = 0.8
+const unsigned int gammaMapGreen[256] PROGMEM = {
+  0x0000, 0x0000, 0x0000, 0x0001, 0x0002, 0x0004, 0x0006, 0x0009,
+  0x000d, 0x0011, 0x0016, 0x001c, 0x0022, 0x0029, 0x0031, 0x003a,
+  0x0044, 0x004f, 0x005a, 0x0067, 0x0075, 0x0083, 0x0092, 0x00a3,
+  0x00b4, 0x00c7, 0x00db, 0x00ef, 0x0105, 0x011c, 0x0134, 0x014e,
+  0x0168, 0x0184, 0x01a0, 0x01be, 0x01de, 0x01fe, 0x0220, 0x0243,
+  0x0267, 0x028c, 0x02b3, 0x02db, 0x0305, 0x0330, 0x035c, 0x038a,
+  0x03b8, 0x03e9, 0x041a, 0x044e, 0x0482, 0x04b8, 0x04f0, 0x0528,
+  0x0563, 0x059f, 0x05dc, 0x061b, 0x065b, 0x069d, 0x06e0, 0x0725,
+  0x076c, 0x07b4, 0x07fd, 0x0849, 0x0895, 0x08e4, 0x0934, 0x0985,
+  0x09d8, 0x0a2d, 0x0a84, 0x0adc, 0x0b36, 0x0b91, 0x0bee, 0x0c4d,
+  0x0cae, 0x0d10, 0x0d74, 0x0dd9, 0x0e41, 0x0eaa, 0x0f15, 0x0f81,
+  0x0ff0, 0x1060, 0x10d2, 0x1145, 0x11bb, 0x1232, 0x12ab, 0x1326,
+  0x13a3, 0x1422, 0x14a2, 0x1524, 0x15a9, 0x162f, 0x16b6, 0x1740,
+  0x17cc, 0x1859, 0x18e9, 0x197a, 0x1a0d, 0x1aa3, 0x1b3a, 0x1bd3,
+  0x1c6e, 0x1d0b, 0x1da9, 0x1e4a, 0x1eed, 0x1f92, 0x2039, 0x20e1,
+  0x218c, 0x2239, 0x22e8, 0x2399, 0x244b, 0x2500, 0x25b7, 0x2670,
+  0x272b, 0x27e8, 0x28a7, 0x2968, 0x2a2c, 0x2af1, 0x2bb8, 0x2c82,
+  0x2d4d, 0x2e1b, 0x2eeb, 0x2fbd, 0x3091, 0x3167, 0x323f, 0x331a,
+  0x33f7, 0x34d5, 0x35b6, 0x3699, 0x377f, 0x3866, 0x3950, 0x3a3c,
+  0x3b2a, 0x3c1a, 0x3d0c, 0x3e01, 0x3ef8, 0x3ff1, 0x40ec, 0x41ea,
+  0x42ea, 0x43ec, 0x44f0, 0x45f7, 0x4700, 0x480b, 0x4918, 0x4a28,
+  0x4b3a, 0x4c4e, 0x4d65, 0x4e7e, 0x4f99, 0x50b6, 0x51d6, 0x52f8,
+  0x541d, 0x5543, 0x566d, 0x5798, 0x58c6, 0x59f6, 0x5b29, 0x5c5e,
+  0x5d95, 0x5ecf, 0x600b, 0x6149, 0x628a, 0x63cd, 0x6513, 0x665b,
+  0x67a5, 0x68f2, 0x6a41, 0x6b93, 0x6ce7, 0x6e3e, 0x6f97, 0x70f2,
+  0x7250, 0x73b1, 0x7514, 0x7679, 0x77e1, 0x794b, 0x7ab8, 0x7c27,
+  0x7d99, 0x7f0d, 0x8084, 0x81fd, 0x8379, 0x84f7, 0x8678, 0x87fb,
+  0x8981, 0x8b09, 0x8c94, 0x8e22, 0x8fb2, 0x9144, 0x92da, 0x9471,
+  0x960c, 0x97a8, 0x9948, 0x9aea, 0x9c8e, 0x9e36, 0x9fdf, 0xa18c,
+  0xa33b, 0xa4ec, 0xa6a0, 0xa857, 0xaa11, 0xabcd, 0xad8b, 0xaf4d,
+  0xb111, 0xb2d7, 0xb4a1, 0xb66d, 0xb83b, 0xba0c, 0xbbe0, 0xbdb7,
+  0xbf90, 0xc16c, 0xc34b, 0xc52c, 0xc710, 0xc8f7, 0xcae0, 0xcccc
+};
+
+// Blue:  gamma = 2.2, scale = 0.9
+const unsigned int gammaMapBlue[256] PROGMEM = {
+  0x0000, 0x0000, 0x0001, 0x0003, 0x0006, 0x000a, 0x000f, 0x0016,
+  0x001d, 0x0026, 0x002f, 0x003b, 0x0047, 0x0055, 0x0063, 0x0074,
+  0x0085, 0x0099, 0x00ad, 0x00c3, 0x00da, 0x00f3, 0x010d, 0x0129,
+  0x0146, 0x0164, 0x0184, 0x01a6, 0x01c9, 0x01ee, 0x0214, 0x023c,
+  0x0265, 0x0290, 0x02bd, 0x02eb, 0x031b, 0x034c, 0x037f, 0x03b4,
+  0x03ea, 0x0422, 0x045c, 0x0497, 0x04d4, 0x0512, 0x0553, 0x0595,
+  0x05d8, 0x061e, 0x0665, 0x06ae, 0x06f9, 0x0745, 0x0793, 0x07e3,
+  0x0835, 0x0888, 0x08dd, 0x0934, 0x098d, 0x09e7, 0x0a44, 0x0aa2,
+  0x0b02, 0x0b64, 0x0bc7, 0x0c2d, 0x0c94, 0x0cfd, 0x0d68, 0x0dd5,
+  0x0e43, 0x0eb4, 0x0f26, 0x0f9a, 0x1011, 0x1089, 0x1102, 0x117e,
+  0x11fc, 0x127b, 0x12fd, 0x1380, 0x1406, 0x148d, 0x1516, 0x15a1,
+  0x162e, 0x16bd, 0x174e, 0x17e0, 0x1875, 0x190c, 0x19a5, 0x1a3f,
+  0x1adc, 0x1b7a, 0x1c1b, 0x1cbd, 0x1d62, 0x1e08, 0x1eb1, 0x1f5b,
+  0x2008, 0x20b6, 0x2167, 0x2219, 0x22ce, 0x2384, 0x243d, 0x24f7,
+  0x25b4, 0x2672, 0x2733, 0x27f6, 0x28ba, 0x2981, 0x2a4a, 0x2b15,
+  0x2be2, 0x2cb1, 0x2d82, 0x2e55, 0x2f2a, 0x3001, 0x30db, 0x31b6,
+  0x3294, 0x3373, 0x3455, 0x3539, 0x361e, 0x3706, 0x37f0, 0x38dd,
+  0x39cb, 0x3abb, 0x3bae, 0x3ca2, 0x3d99, 0x3e92, 0x3f8d, 0x408a,
+  0x4189, 0x428b, 0x438e, 0x4494, 0x459c, 0x46a6, 0x47b2, 0x48c0,
+  0x49d1, 0x4ae3, 0x4bf8, 0x4d0f, 0x4e28, 0x4f43, 0x5061, 0x5180,
+  0x52a2, 0x53c6, 0x54ec, 0x5614, 0x573f, 0x586c, 0x599b, 0x5acc,
+  0x5bff, 0x5d34, 0x5e6c, 0x5fa6, 0x60e2, 0x6221, 0x6361, 0x64a4,
+  0x65e9, 0x6730, 0x687a, 0x69c5, 0x6b13, 0x6c63, 0x6db6, 0x6f0a,
+  0x7061, 0x71ba, 0x7316, 0x7473, 0x75d3, 0x7735, 0x7899, 0x7a00,
+  0x7b69, 0x7cd4, 0x7e41, 0x7fb1, 0x8123, 0x8297, 0x840e, 0x8587,
+  0x8702, 0x887f, 0x89fe, 0x8b80, 0x8d05, 0x8e8b, 0x9014, 0x919f,
+  0x932c, 0x94bc, 0x964e, 0x97e2, 0x9979, 0x9b11, 0x9cad, 0x9e4a,
+  0x9fea, 0xa18c, 0xa330, 0xa4d7, 0xa680, 0xa82c, 0xa9d9, 0xab8a,
+  0xad3c, 0xaef1, 0xb0a8, 0xb261, 0xb41d, 0xb5db, 0xb79b, 0xb95e,
+  0xbb23, 0xbceb, 0xbeb5, 0xc081, 0xc24f, 0xc420, 0xc5f3, 0xc7c9,
+  0xc9a1, 0xcb7b, 0xcd58, 0xcf37, 0xd118, 0xd2fc, 0xd4e3, 0xd6cb,
+  0xd8b6, 0xdaa3, 0xdc93, 0xde85, 0xe07a, 0xe271, 0xe46a, 0xe666
+};
+
+static const unsigned int *const gammaMaps[] = {
+  gammaMapRed, gammaMapGreen, gammaMapBlue
+};
+
+#define GAMMA_MAP(color) gammaMaps[color]
+
+#endif
+
+#endif
@@ -10,9 +10,6 @@
  * ~~~~
  * - Check all parameter bounds !
  * - Implement pattern scripting over serial line.
- * - Color gamma correction map for each LED intensity in Flash memory.
- *   - See post #37 http://www.microchip.com/forums/m479196-p2.aspx
- *   - See neuroelec.com/2011/04/led-brightness-to-your-eye-gamma-correction-no
  * - Scriptable sequence stored in EEPROM.
  * - Plugable sequence in third-party code.
  */
@@ -23,6 +20,31 @@
 #include "Cube.h"
 #include "graphics.h"
 
+// Bulk operations use the block kernels in frame.h, then mark the Z planes
+// dirty and move the cursor once, to where setting each voxel in turn would
+// have left it.
+
+static void markAllDirty(void) {
+  volatile byte *dirty = ledDrawDirty;
+  for (byte z = 0;  z < CUBE_SIZE;  z++) dirty[z] = LED_DIRTY_PLANE;
+}
+
+static void planeDone(
+  byte axis,
+  byte position) {
+
+  if (axis == Z) {
+    ledDrawDirty[position] = LED_DIRTY_PLANE;
+  }
+  else {
+    markAllDirty();
+  }
+
+  cursorX = (axis == X)  ?  position  :  CUBE_SIZE - 1;
+  cursorY = (axis == Y)  ?  position  :  CUBE_SIZE - 1;
+  cursorZ = (axis == Z)  ?  position  :  CUBE_SIZE - 1;
+}
+
 void Cube::all(
   rgb_t rgb) {
 
@@ -32,7 +54,12 @@ void Cube::all(
 void cubeAll(
   rgb_t rgb) {
 
-  for (byte z = 0;  z < CUBE_SIZE;  z++) cubeFillPlaneZ(z, rgb);
+  frameFill(led, rgb);
+  markAllDirty();
+
+  cursorX = CUBE_SIZE - 1;
+  cursorY = CUBE_SIZE - 1;
+  cursorZ = CUBE_SIZE - 1;
 }
 
 void Cube::fillPlaneZ(
@@ -46,11 +73,8 @@ void cubeFillPlaneZ(
   byte  z,
   rgb_t rgb) {
 
-  for (byte y = 0;  y < CUBE_SIZE;  y++) {
-    for (byte x = 0;  x < CUBE_SIZE;  x++) {
-      cubeSet(x, y, z, rgb);
-    }
-  }
+  frameFillPlane(led, Z, z, rgb);
+  planeDone(Z, z);
 }
 
 void Cube::set(
@@ -68,9 +92,8 @@ void cubeSet(
   byte  z,
   rgb_t rgb) {
 
-  led[x][y][z].color[COLOR_PLANE_RED]   = rgb.color[COLOR_PLANE_RED];
-  led[x][y][z].color[COLOR_PLANE_GREEN] = rgb.color[COLOR_PLANE_GREEN];
-  led[x][y][z].color[COLOR_PLANE_BLUE]  = rgb.color[COLOR_PLANE_BLUE];
+  framePut(led, x, y, z, rgb);
+  ledDrawDirty[z] = LED_DIRTY_PLANE;
 
   cursorX = x;
   cursorY = y;
@@ -105,12 +128,211 @@ void cubeNext(
   cubeSet(cursorX, cursorY, cursorZ, rgb);
 }
 
-void Swap(
-  byte &a,
-  byte &b) {
-  byte c = a;
-  a = b;
-  b = c;
+// Integer rasterization.  Each primitive works out its bounding box once: if
+// that is inside the cube no voxel is bounds checked, if it is outside
+// nothing is drawn, otherwise each voxel is checked.  The cursor is left at
+// the last voxel drawn.
+
+static const byte RASTER_INSIDE  = 0;
+static const byte RASTER_CLIPPED = 1;
+static const byte RASTER_OUTSIDE = 2;
+
+static byte  rasterClip;
+static rgb_t rasterColor;
+static bool  rasterDrawn;
+static byte  rasterX, rasterY, rasterZ;
+
+static byte rasterBegin(
+  rgb_t rgb,
+  int   minX,
+  int   minY,
+  int   minZ,
+  int   maxX,
+  int   maxY,
+  int   maxZ) {
+
+  rasterColor = rgb;
+  rasterDrawn = false;
+
+  if (maxX < 0  ||  maxY < 0  ||  maxZ < 0  ||
+      minX >= CUBE_SIZE  ||  minY >= CUBE_SIZE  ||  minZ >= CUBE_SIZE) {
+    rasterClip = RASTER_OUTSIDE;
+  }
+  else if (minX < 0  ||  minY < 0  ||  minZ < 0  ||
+           maxX >= CUBE_SIZE  ||  maxY >= CUBE_SIZE  ||  maxZ >= CUBE_SIZE) {
+    rasterClip = RASTER_CLIPPED;
+  }
+  else {
+    rasterClip = RASTER_INSIDE;
+  }
+
+  return(rasterClip);
+}
+
+static inline void rasterVoxel(
+  int x,
+  int y,
+  int z) {
+
+  if (rasterClip == RASTER_CLIPPED  &&
+      ((unsigned int) x >= CUBE_SIZE  ||
+       (unsigned int) y >= CUBE_SIZE  ||
+       (unsigned int) z >= CUBE_SIZE)) return;
+
+  framePut(led, x, y, z, rasterColor);
+  ledDrawDirty[z] = LED_DIRTY_PLANE;
+
+  rasterX = x;
+  rasterY = y;
+  rasterZ = z;
+  rasterDrawn = true;
+}
+
+static void rasterEnd(void) {
+  if (rasterDrawn) {
+    cursorX = rasterX;
+    cursorY = rasterY;
+    cursorZ = rasterZ;
+  }
+}
+
+// The axis with the longest delta, preferring X then Y when equal
+
+static inline byte lineMajorAxis(
+  int *delta) {
+
+  byte major = X;
+  if (delta[Y] > delta[major]) major = Y;
+  if (delta[Z] > delta[major]) major = Z;
+  return(major);
+}
+
+// http://en.wikipedia.org/wiki/Bresenham's_line_algorithm
+static void rasterLine(
+  int x1,
+  int y1,
+  int z1,
+  int x2,
+  int y2,
+  int z2) {
+
+  int point[3] = { x1, y1, z1 };
+  int delta[3] = { abs(x2 - x1), abs(y2 - y1), abs(z2 - z1) };
+  int step[3]  = { x1 > x2 ? -1 : 1, y1 > y2 ? -1 : 1, z1 > z2 ? -1 : 1 };
+
+  // step through the longest delta, the others drift as they fall behind
+  byte major  = lineMajorAxis(delta);
+  byte minor1 = (major + 1) % 3;
+  byte minor2 = (major + 2) % 3;
+
+  // starting value keeps the line centred
+  int drift1 = delta[major] / 2;
+  int drift2 = delta[major] / 2;
+
+  for (int count = delta[major];  count >= 0;  count --) {
+    rasterVoxel(point[X], point[Y], point[Z]);
+    point[major] += step[major];
+
+    drift1 -= delta[minor1];
+    if (drift1 < 0) {
+      point[minor1] += step[minor1];
+      drift1 += delta[major];
+    }
+
+    drift2 -= delta[minor2];
+    if (drift2 < 0) {
+      point[minor2] += step[minor2];
+      drift2 += delta[major];
+    }
+  }
+}
+
+static long divideRounded(
+  long numerator,
+  long denominator) {
+
+  if (denominator < 0) {
+    numerator   = -numerator;
+    denominator = -denominator;
+  }
+
+  if (numerator >= 0) return((numerator + denominator / 2) / denominator);
+  return(-((-numerator + denominator / 2) / denominator));
+}
+
+/* Fill the triangle's projection onto the plane of the two axes it is most
+ * parallel to (so there are no gaps), taking the third coordinate from the
+ * triangle's plane, then draw the edges.
+ */
+static void rasterTriangle(
+  int *a,
+  int *b,
+  int *c) {
+
+  long ab[3] = { b[X] - a[X], b[Y] - a[Y], b[Z] - a[Z] };
+  long ac[3] = { c[X] - a[X], c[Y] - a[Y], c[Z] - a[Z] };
+
+  long normal[3] = {
+    ab[Y] * ac[Z] - ab[Z] * ac[Y],
+    ab[Z] * ac[X] - ab[X] * ac[Z],
+    ab[X] * ac[Y] - ab[Y] * ac[X]
+  };
+
+  long magnitude[3] = { labs(normal[X]), labs(normal[Y]), labs(normal[Z]) };
+
+  byte k = X;
+  if (magnitude[Y] > magnitude[k]) k = Y;
+  if (magnitude[Z] > magnitude[k]) k = Z;
+
+  if (normal[k] != 0) {                        // Otherwise just the edges
+    byte u = (k + 1) % 3;
+    byte v = (k + 2) % 3;
+    int  sign = (normal[k] > 0)  ?  1  :  -1;
+
+    int minU = max(min(min(a[u], b[u]), c[u]), 0);
+    int maxU = min(max(max(a[u], b[u]), c[u]), CUBE_SIZE - 1);
+    int minV = max(min(min(a[v], b[v]), c[v]), 0);
+    int maxV = min(max(max(a[v], b[v]), c[v]), CUBE_SIZE - 1);
+
+    int *vertex[3] = { a, b, c };
+    long edge[3];                              // Edge functions at (minU, V)
+    long edgeStepU[3];
+    long edgeStepV[3];
+
+    for (byte e = 0;  e < 3;  e ++) {
+      int *p = vertex[e];
+      int *q = vertex[(e + 1) % 3];
+
+      edgeStepU[e] = -(long) (q[v] - p[v]) * sign;
+      edgeStepV[e] =  (long) (q[u] - p[u]) * sign;
+      edge[e] = edgeStepV[e] * (minV - p[v]) + edgeStepU[e] * (minU - p[u]);
+    }
+
+    int point[3];
+
+    for (int pointV = minV;  pointV <= maxV;  pointV ++) {
+      long inside[3] = { edge[0], edge[1], edge[2] };
+
+      for (int pointU = minU;  pointU <= maxU;  pointU ++) {
+        if (inside[0] >= 0  &&  inside[1] >= 0  &&  inside[2] >= 0) {
+          point[u] = pointU;
+          point[v] = pointV;
+          point[k] = a[k] + divideRounded(
+            -(normal[u] * (pointU - a[u]) + normal[v] * (pointV - a[v])), normal[k]);
+
+          rasterVoxel(point[X], point[Y], point[Z]);
+        }
+
+        for (byte e = 0;  e < 3;  e ++) inside[e] += edgeStepU[e];
+      }
+
+      for (byte e = 0;  e < 3;  e ++) edge[e] += edgeStepV[e];
+    }
+  }
+
+  rasterLine(a[X], a[Y], a[Z], b[X], b[Y], b[Z]);
+  rasterLine(b[X], b[Y], b[Z], c[X], c[Y], c[Z]);
+  rasterLine(c[X], c[Y], c[Z], a[X], a[Y], a[Z]);
 }
 
 void Cube::line(
@@ -120,12 +342,15 @@ void Cube::line(
   byte x2,
   byte y2,
   byte z2,
-  rgb_t rgb) {
+  rgb_t rgb,
+  byte thickness) {
 
-  cubeLine(x1, y1, z1, x2, y2, z2, rgb);
+  cubeLine(x1, y1, z1, x2, y2, z2, rgb, thickness);
 }
 
-// http://en.wikipedia.org/wiki/Bresenham's_line_algorithm
+/* Thick lines are drawn as thickness x thickness parallel lines, offset
+ * across the longest axis.
+ */
 void cubeLine(
   byte x1,
   byte y1,
@@ -133,102 +358,126 @@ void cubeLine(
   byte x2,
   byte y2,
   byte z2,
-  rgb_t rgb) {
+  rgb_t rgb,
+  byte thickness) {
 
-  byte x;
-  byte delta_x;
-  byte step_x;
-  byte y;
-  byte delta_y;
-  byte step_y;
-  byte z;
-  byte delta_z;
-  byte step_z;
-  boolean swap_xy;
-  boolean swap_xz;
-  float drift_xy;
-  float drift_xz;
-  byte cx;
-  byte cy;
-  byte cz;
-  
-  // 'steep' xy Line, make longest delta x plane  
-  swap_xy = abs(y2 - y1) > abs(x2 - x1);
-  if (swap_xy) {
-      Swap(x1, y1);
-      Swap(x2, y2);
-  }
-              
-  // do same for xz
-  swap_xz = abs(z2 - z1) > abs(x2 - x1);
-  if (swap_xz) {
-      Swap(x1, z1);
-      Swap(x2, z2);
-  }
-  
-  // delta is Length in each plane
-  delta_x = abs(x2 - x1);
-  delta_y = abs(y2 - y1);
-  delta_z = abs(z2 - z1);
-  
-  // drift controls when to step in 'shallow' planes
-  // starting value keeps Line centred
-  drift_xy = (delta_x / 2);
-  drift_xz = (delta_x / 2);
-  
-  // direction of line
-  step_x = 1;
-  if (x1 > x2) {
-    step_x = -1;
-  }
-  step_y = 1;
-  if (y1 > y2) {
-    step_y = -1;
-  }
-  step_z = 1;
-  if (z1 > z2) {
-    step_z = -1;
-  }
-  
-  // starting point
-  y = y1;
-  z = z1;
-  
-  // step through longest delta (which we have swapped to x)
-  for (x = x1; x != x2 + step_x; x += step_x) {
-      
-      // copy position
-      cx = x;
-      cy = y;
-      cz = z;
-
-      // unswap (in reverse)
-      if (swap_xz) {
-        Swap(cx, cz);
-      }
-      if (swap_xy) {
-        Swap(cx, cy);
-      }
+  if (thickness == 0) thickness = 1;
 
-      // passes through this point
-      cubeSet(cx, cy, cz, rgb);
-      
-      // update progress in other planes
-      drift_xy = drift_xy - delta_y;
-      drift_xz = drift_xz - delta_z;
-
-      // step in y plane
-      if (drift_xy < 0) {
-          y = y + step_y;
-          drift_xy = drift_xy + delta_x;
-      }  
-      
-      // same in z
-      if (drift_xz < 0) {
-          z = z + step_z;
-          drift_xz = drift_xz + delta_x;
-      }
+  int low  = -((thickness - 1) / 2);
+  int high = thickness / 2;
+
+  if (rasterBegin(rgb,
+        min(x1, x2) + low,  min(y1, y2) + low,  min(z1, z2) + low,
+        max(x1, x2) + high, max(y1, y2) + high, max(z1, z2) + high) == RASTER_OUTSIDE) return;
+
+  int delta[3] = { abs(x2 - x1), abs(y2 - y1), abs(z2 - z1) };
+  byte major  = lineMajorAxis(delta);
+  byte minor1 = (major + 1) % 3;
+  byte minor2 = (major + 2) % 3;
+
+  for (int offset1 = low;  offset1 <= high;  offset1 ++) {
+    for (int offset2 = low;  offset2 <= high;  offset2 ++) {
+      int offset[3];
+      offset[major]  = 0;
+      offset[minor1] = offset1;
+      offset[minor2] = offset2;
+
+      rasterLine(
+        x1 + offset[X], y1 + offset[Y], z1 + offset[Z],
+        x2 + offset[X], y2 + offset[Y], z2 + offset[Z]);
+    }
   }
+
+  rasterEnd();
+}
+
+void Cube::triangle(
+  byte x1,
+  byte y1,
+  byte z1,
+  byte x2,
+  byte y2,
+  byte z2,
+  byte x3,
+  byte y3,
+  byte z3,
+  rgb_t rgb) {
+
+  cubeTriangle(x1, y1, z1, x2, y2, z2, x3, y3, z3, rgb);
+}
+
+void cubeTriangle(
+  byte x1,
+  byte y1,
+  byte z1,
+  byte x2,
+  byte y2,
+  byte z2,
+  byte x3,
+  byte y3,
+  byte z3,
+  rgb_t rgb) {
+
+  if (rasterBegin(rgb,
+        min(min(x1, x2), x3), min(min(y1, y2), y3), min(min(z1, z2), z3),
+        max(max(x1, x2), x3), max(max(y1, y2), y3), max(max(z1, z2), z3)) == RASTER_OUTSIDE) return;
+
+  int a[3] = { x1, y1, z1 };
+  int b[3] = { x2, y2, z2 };
+  int c[3] = { x3, y3, z3 };
+
+  rasterTriangle(a, b, c);
+  rasterEnd();
+}
+
+void Cube::quad(
+  byte x1,
+  byte y1,
+  byte z1,
+  byte x2,
+  byte y2,
+  byte z2,
+  byte x3,
+  byte y3,
+  byte z3,
+  byte x4,
+  byte y4,
+  byte z4,
+  rgb_t rgb) {
+
+  cubeQuad(x1, y1, z1, x2, y2, z2, x3, y3, z3, x4, y4, z4, rgb);
+}
+
+/* Corners in order around the edge, drawn as two triangles split along the
+ * first to third corner diagonal.
+ */
+void cubeQuad(
+  byte x1,
+  byte y1,
+  byte z1,
+  byte x2,
+  byte y2,
+  byte z2,
+  byte x3,
+  byte y3,
+  byte z3,
+  byte x4,
+  byte y4,
+  byte z4,
+  rgb_t rgb) {
+
+  if (rasterBegin(rgb,
+        min(min(x1, x2), min(x3, x4)), min(min(y1, y2), min(y3, y4)), min(min(z1, z2), min(z3, z4)),
+        max(max(x1, x2), max(x3, x4)), max(max(y1, y2), max(y3, y4)), max(max(z1, z2), max(z3, z4))) == RASTER_OUTSIDE) return;
+
+  int a[3] = { x1, y1, z1 };
+  int b[3] = { x2, y2, z2 };
+  int c[3] = { x3, y3, z3 };
+  int d[3] = { x4, y4, z4 };
+
+  rasterTriangle(a, b, c);
+  rasterTriangle(a, c, d);
+  rasterEnd();
 }
 
 void Cube::box(
@@ -314,6 +563,25 @@ void Cube::sphere(
   cubeSphere(x1, y1, z1, size, rgb, fill);
 }
 
+// The range of a sphere's box along one axis, clipped to the cube, or false
+// when it is all outside
+
+static bool sphereBox(
+  byte  centre,
+  byte  size,
+  byte *low,
+  byte *high) {
+
+  int first = centre - (int) ((size - 1) / 2);
+  int last  = first + size - 1;
+
+  if (first > CUBE_SIZE - 1  ||  last < 0) return(false);
+
+  *low  = max(first, 0);
+  *high = min(last, CUBE_SIZE - 1);
+  return(true);
+}
+
 void cubeSphere(
   byte x1,
   byte y1,
@@ -322,36 +590,141 @@ void cubeSphere(
   rgb_t rgb,
   rgb_t fill) {
 
-  byte subtract;
-  byte add;
-  byte x2;
-  byte y2;
-  byte z2;
-
-  // Dodgy, but it works because we are only dealing with 4x4x4
-  if (size <= 2) {
-    add = size - 1;
-    x2 = x1 + add;
-    y2 = y1 + add;
-    z2 = z1 + add;
-    cubeBox(x1, y1, z1, x2, y2, z2, rgb);
-  } else {
-    if (size == 3) {
-      subtract = 1;
-      add = 1;
-    } else {
-      subtract = 1;
-      add = 2;
+  // As the original spheres did, the rest of the sphere's box is cleared
+
+  byte lowX, lowY, lowZ, highX, highY, highZ;
+
+  if (size >= 3  &&
+      sphereBox(x1, size, & lowX, & highX)  &&
+      sphereBox(y1, size, & lowY, & highY)  &&
+      sphereBox(z1, size, & lowZ, & highZ)) {
+
+    cubeBox(lowX, lowY, lowZ, highX, highY, highZ, BLACK);
+  }
+
+  cubeEllipsoid(x1, y1, z1, size, size, size, rgb, 3, fill);
+}
+
+void Cube::ellipsoid(
+  byte x1,
+  byte y1,
+  byte z1,
+  byte sizeX,
+  byte sizeY,
+  byte sizeZ,
+  rgb_t rgb,
+  byte style,
+  rgb_t fill) {
+
+  cubeEllipsoid(x1, y1, z1, sizeX, sizeY, sizeZ, rgb, style, fill);
+}
+
+// Ellipsoids are worked out in half voxels, so that even sizes are centred
+// between voxels.  A voxel is inside when the sum over the axes of
+// distance^2 / (radius^2 - radius + 1) is at most one, which gives the same
+// shapes as the original 4x4x4 spheres.  The per axis terms are looked up in
+// tables of 16.16 fixed point values, for the voxels from -1 to CUBE_SIZE.
+
+static const unsigned long ELLIPSOID_ONE     = 65536;
+static const unsigned long ELLIPSOID_OUTSIDE = ELLIPSOID_ONE + 1;
+
+// Fills the table for one axis and returns the range of voxels in the cube
+// that can be inside, or false when there are none.
+
+static bool ellipsoidAxis(
+  unsigned long *table,
+  byte           centre,
+  byte           size,
+  int           *minimum,
+  int           *maximum) {
+
+  unsigned long limit = (unsigned long) size * size - size + 1;
+  int centre2 = 2 * centre + ((size & 1) == 0);
+
+  *minimum = CUBE_SIZE;
+  *maximum = -1;
+
+  for (int v = -1;  v <= CUBE_SIZE;  v ++) {
+    long distance = 2 * v - centre2;
+    unsigned long distance2 = distance * distance;
+
+    if (distance2 > limit) {
+      table[v + 1] = ELLIPSOID_OUTSIDE;
+      continue;
+    }
+
+    table[v + 1] = (distance2 << 16) / limit;
+
+    if (v >= 0  &&  v < CUBE_SIZE) {
+      if (v < *minimum) *minimum = v;
+      *maximum = v;
     }
-    x2 = x1 + add;
-    y2 = y1 + add;
-    z2 = z1 + add;
-    x1 -= subtract;
-    y1 -= subtract;
-    z1 -= subtract;
-    cubeBox(x1, y1, z1, x2, y2, z2, BLACK, 4, rgb);
-    cubeBox(x1+1, y1+1, z1+1, x2-1, y2-1, z2-1, fill);
   }
+
+  return(*maximum >= 0);
+}
+
+void cubeEllipsoid(
+  byte x1,
+  byte y1,
+  byte z1,
+  byte sizeX,
+  byte sizeY,
+  byte sizeZ,
+  rgb_t rgb,
+  byte style,
+  rgb_t fill) {
+
+  unsigned long tableX[CUBE_SIZE + 2];
+  unsigned long tableY[CUBE_SIZE + 2];
+  unsigned long tableZ[CUBE_SIZE + 2];
+  int minX, minY, minZ, maxX, maxY, maxZ;
+
+  if (sizeX == 0  ||  sizeY == 0  ||  sizeZ == 0) return;
+
+  if (! ellipsoidAxis(tableX, x1, sizeX, & minX, & maxX)  ||
+      ! ellipsoidAxis(tableY, y1, sizeY, & minY, & maxY)  ||
+      ! ellipsoidAxis(tableZ, z1, sizeZ, & minZ, & maxZ)) return;
+
+  // The range is clipped to the cube already, so no voxel is bounds checked
+  rasterBegin(rgb, minX, minY, minZ, maxX, maxY, maxZ);
+
+  for (int z = minZ;  z <= maxZ;  z ++) {
+    unsigned long *dz = tableZ + z + 1;
+
+    for (int y = minY;  y <= maxY;  y ++) {
+      unsigned long *dy = tableY + y + 1;
+      unsigned long  yz = dy[0] + dz[0];
+
+      if (yz > ELLIPSOID_ONE) continue;
+
+      for (int x = minX;  x <= maxX;  x ++) {
+        unsigned long *dx = tableX + x + 1;
+
+        if (dx[0] + yz > ELLIPSOID_ONE) continue;
+
+        if (style != 0) {
+          // Inside voxels with all six neighbours inside are not the shell
+          bool shell =
+            dx[-1] + yz > ELLIPSOID_ONE  ||  dx[1] + yz > ELLIPSOID_ONE  ||
+            dx[0] + dy[-1] + dz[0] > ELLIPSOID_ONE  ||  dx[0] + dy[1] + dz[0] > ELLIPSOID_ONE  ||
+            dx[0] + dy[0] + dz[-1] > ELLIPSOID_ONE  ||  dx[0] + dy[0] + dz[1] > ELLIPSOID_ONE;
+
+          if (! shell) {
+            if (style != 3) continue;
+            rasterColor = fill;
+            rasterVoxel(x, y, z);
+            rasterColor = rgb;
+            continue;
+          }
+        }
+
+        rasterVoxel(x, y, z);
+      }
+    }
+  }
+
+  rasterEnd();
 }
 
 void Cube::shift(
@@ -365,20 +738,12 @@ void cubeShift(
   byte axis,
   byte direction) {
 
-  if( direction == '+' )
-  {
-    for (byte i = CUBE_SIZE - 1; i > 0; i--) {
-      cubeCopyplane(axis, i - 1, i);
-    }
-    cubeSetplane(axis, 0, BLACK);
-  }
-  if( direction == '-' )
-  {
-    for (byte i = 0; i < CUBE_SIZE - 1; i++) {
-      cubeCopyplane(axis, i + 1, i);
-    }
-    cubeSetplane(axis, 3, BLACK);
-  }
+  if (axis > Z  ||  (direction != '+'  &&  direction != '-')) return;
+
+  frameShift(led, axis, direction);
+  markAllDirty();
+
+  cubeSetplane(axis, (direction == '+')  ?  0  :  CUBE_SIZE - 1, BLACK);
 }
 
 void Cube::copyplane(
@@ -394,37 +759,10 @@ void cubeCopyplane(
   byte position,
   byte destination) {
 
-  if( axis == X)
-  {
+  if (axis > Z) return;
 
-    byte y = 0;
-    byte z = 0;
-    for (byte z = 0;  z < CUBE_SIZE;  z++) {
-      for (byte y = 0;  y < CUBE_SIZE;  y++) {
-        cubeSet(destination, y, z, RGB(led[position][y][z].color[COLOR_PLANE_RED], led[position][y][z].color[COLOR_PLANE_GREEN], led[position][y][z].color[COLOR_PLANE_BLUE]));
-      }
-    }
-  }
-  if( axis == Y)
-  {
-    byte x = 0;
-    byte z = 0;
-    for (byte z = 0;  z < CUBE_SIZE;  z++) {
-      for (byte x = 0;  x < CUBE_SIZE;  x++) {
-        cubeSet(x, destination, z, RGB(led[x][position][z].color[COLOR_PLANE_RED], led[x][position][z].color[COLOR_PLANE_GREEN], led[x][position][z].color[COLOR_PLANE_BLUE]));
-      }
-    }
-  }
-  if( axis == Z)
-  {
-    byte x = 0;
-    byte y = 0;
-    for (byte y = 0;  y < CUBE_SIZE;  y++) {
-      for (byte x = 0;  x < CUBE_SIZE;  x++) {
-        cubeSet(x, y, destination, RGB(led[x][y][position].color[COLOR_PLANE_RED], led[x][y][position].color[COLOR_PLANE_GREEN], led[x][y][position].color[COLOR_PLANE_BLUE]));
-      }
-    }
-  }
+  if (position != destination) frameCopyPlane(led, axis, position, destination);
+  planeDone(axis, destination);
 }
 
 void Cube::moveplane(
@@ -459,38 +797,10 @@ void cubeSetplane(
   byte offset,
   rgb_t rgb) {
 
-  if( axis == X)
-  {
-    byte y = 0;
-    byte z = 0;
-    for (byte z = 0;  z < CUBE_SIZE;  z++) {
-      for (byte y = 0;  y < CUBE_SIZE;  y++) {
-        cubeSet(offset, y, z, rgb);
-      }
-    }
-  }
+  if (axis > Z) return;
 
-  if( axis == Y)
-  {
-    byte x = 0;
-    byte z = 0;
-    for (byte z = 0;  z < CUBE_SIZE;  z++) {
-      for (byte x = 0;  x < CUBE_SIZE;  x++) {
-        cubeSet(x, offset, z, rgb);
-      }
-    }
-  }
-
-  if( axis == Z)
-  {
-    byte x = 0;
-    byte y = 0;
-    for (byte y = 0;  y < CUBE_SIZE;  y++) {
-      for (byte x = 0;  x < CUBE_SIZE;  x++) {
-        cubeSet(x, y, offset, rgb);
-      }
-    }
-  }
+  frameFillPlane(led, axis, offset, rgb);
+  planeDone(axis, offset);
 }
 
 
@@ -0,0 +1,176 @@
+/*
+ * File:    layer.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Compositing layers, see CUBE_LAYERS in Cube.h.
+ *
+ * Drawing goes into the selected layer (led and ledDrawDirty point at it).
+ * cubeCompose() blends the layers, bottom to top, into ledBack for each Z
+ * plane that any layer has changed, in 8 bit fixed point.
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+#ifdef CUBE_LAYERS
+
+frame_t       layerBuffer[CUBE_LAYERS];
+volatile byte layerDirty[CUBE_LAYERS][CUBE_SIZE];
+
+static byte layerMode[CUBE_LAYERS];
+static byte layerOpacity[CUBE_LAYERS];
+static bool layerChanged = true;                  // Blend settings, compose all
+
+void Cube::layer(
+  byte index) {
+
+  cubeLayer(index);
+}
+
+void cubeLayer(
+  byte index) {
+
+  if (index >= CUBE_LAYERS) return;
+
+  led          = & layerBuffer[index];
+  ledDrawDirty = layerDirty[index];
+}
+
+void Cube::layerBlend(
+  byte index,
+  byte mode,
+  byte opacity) {
+
+  cubeLayerBlend(index, mode, opacity);
+}
+
+void cubeLayerBlend(
+  byte index,
+  byte mode,
+  byte opacity) {
+
+  if (index >= CUBE_LAYERS  ||  mode > LAYER_ALPHA) return;
+
+  layerMode[index]    = mode;
+  layerOpacity[index] = opacity;
+  layerChanged = true;
+}
+
+void cubeLayersReset(void) {
+  for (byte index = 0;  index < CUBE_LAYERS;  index ++) {
+    cubeLayerBlend(index, (index == 0)  ?  LAYER_REPLACE  :  LAYER_ALPHA);
+  }
+  cubeLayer(0);
+}
+
+// value * opacity / 255, exact for opacity 0 and 255
+
+static inline byte blendScale(
+  byte value,
+  byte opacity) {
+
+  return(((unsigned int) value * (opacity + 1)) >> 8);
+}
+
+// From below to above by opacity
+
+static inline byte blendMix(
+  byte below,
+  byte above,
+  byte opacity) {
+
+  if (above >= below) return(below + blendScale(above - below, opacity));
+  return(below - blendScale(below - above, opacity));
+}
+
+static inline byte blendColor(
+  byte below,
+  byte above,
+  byte mode,
+  byte opacity) {
+
+  switch (mode) {
+    case LAYER_ADD: {
+      unsigned int sum = below + blendScale(above, opacity);
+      return((sum > 255)  ?  255  :  sum);
+    }
+
+    case LAYER_MULTIPLY:
+      return(blendMix(below, blendScale(below, above), opacity));
+
+    case LAYER_MAX: {
+      byte value = blendScale(above, opacity);
+      return((value > below)  ?  value  :  below);
+    }
+
+    default:                                      // LAYER_REPLACE, LAYER_ALPHA
+      return(blendMix(below, above, opacity));
+  }
+}
+
+static void composePlaneZ(
+  byte z) {
+
+  // An opaque LAYER_REPLACE layer hides all of the layers below it
+  byte bottom = 0;
+  for (byte index = CUBE_LAYERS - 1;  index > 0;  index --) {
+    if (layerMode[index] == LAYER_REPLACE  &&  layerOpacity[index] == 255) {
+      bottom = index;
+      break;
+    }
+  }
+
+  for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+    for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+      rgb_t rgb = BLACK;
+
+      for (byte index = bottom;  index < CUBE_LAYERS;  index ++) {
+        byte mode    = layerMode[index];
+        byte opacity = layerOpacity[index];
+
+        if (opacity == 0) continue;
+
+        rgb_t above = frameGet(& layerBuffer[index], x, y, z);
+
+        if (mode == LAYER_ALPHA  &&
+            (above.color[0] | above.color[1] | above.color[2]) == 0) continue;
+
+        for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+          rgb.color[color] = blendColor(rgb.color[color], above.color[color], mode, opacity);
+        }
+      }
+
+      framePut(ledBack, x, y, z, rgb);
+    }
+  }
+
+  ledBackDirty[z] = LED_DIRTY_PLANE;
+}
+
+void Cube::compose()
+{
+  cubeCompose();
+}
+
+void cubeCompose(void) {
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+    bool changed = layerChanged;
+
+    for (byte index = 0;  index < CUBE_LAYERS;  index ++) {
+      if (layerDirty[index][z]) {
+        layerDirty[index][z] = 0;
+        changed = true;
+      }
+    }
+
+    if (changed) composePlaneZ(z);
+  }
+
+  layerChanged = false;
+}
+#endif
+#endif
@@ -0,0 +1,148 @@
+/*
+ * File:    palette.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Indexed color frames, see CUBE_PALETTE in Cube.h.
+ *
+ * The frames hold palette indexes (see frame.h), which are expanded through
+ * framePalette[] as each slice is serialized for the LED drivers.  So changing a
+ * palette color only marks every slice of every buffer for serializing
+ * again, and the voxels themselves are never touched.
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+#ifdef CUBE_PALETTE
+
+rgb_t framePalette[CUBE_PALETTE];
+
+// Palette colors after Cube::begin(), any further entries are BLACK
+
+static const byte PALETTE_DEFAULTS = 16;
+
+static const rgb_t paletteDefaults[PALETTE_DEFAULTS] PROGMEM = {
+  BLACK, RED, GREEN, BLUE, YELLOW, PURPLE, RGB(0x00, 0xff, 0xff), WHITE,
+  ORANGE, PINK,
+  RGB(0x80, 0x00, 0x00), RGB(0x00, 0x80, 0x00), RGB(0x00, 0x00, 0x80),
+  RGB(0x80, 0x80, 0x00), RGB(0x80, 0x00, 0x80), RGB(0x80, 0x80, 0x80)
+};
+
+// Drawing primitives put many voxels of one color in a row, so remember the
+// last color looked up
+
+static rgb_t paletteLastColor;
+static byte  paletteLastIndex;
+static bool  paletteLastValid = false;
+
+// The index of the nearest palette color, by the sum of the differences of
+// red, green and blue (the lowest index of the nearest colors)
+
+byte framePaletteIndex(
+  rgb_t rgb) {
+
+  if (paletteLastValid  &&  memcmp(& rgb, & paletteLastColor, sizeof(rgb_t)) == 0) {
+    return(paletteLastIndex);
+  }
+
+  unsigned int nearest = 0xffff;
+  byte found = 0;
+
+  for (unsigned int index = 0;  index < CUBE_PALETTE;  index ++) {
+    unsigned int distance = 0;
+
+    for (byte color = 0;  color < COLOR_PLANES;  color ++) {
+      distance += abs((int) rgb.color[color] - framePalette[index].color[color]);
+    }
+
+    if (distance < nearest) {
+      nearest = distance;
+      found   = index;
+      if (distance == 0) break;
+    }
+  }
+
+  paletteLastColor = rgb;
+  paletteLastIndex = found;
+  paletteLastValid = true;
+
+  return(found);
+}
+
+static void paletteChanged(void) {
+  paletteLastValid = false;
+  cubeDirtyAllBuffers();
+}
+
+void Cube::palette(
+  byte  index,
+  rgb_t rgb) {
+
+  cubePalette(index, rgb);
+}
+
+void cubePalette(
+  byte  index,
+  rgb_t rgb) {
+
+  if (index >= CUBE_PALETTE) return;
+
+  framePalette[index] = rgb;
+  paletteChanged();
+}
+
+rgb_t Cube::paletteColor(
+  byte index) {
+
+  return(cubePaletteColor(index));
+}
+
+rgb_t cubePaletteColor(
+  byte index) {
+
+  return((index < CUBE_PALETTE)  ?  framePalette[index]  :  BLACK);
+}
+
+void Cube::paletteRotate(
+  byte first,
+  byte last,
+  byte direction) {
+
+  cubePaletteRotate(first, last, direction);
+}
+
+void cubePaletteRotate(
+  byte first,
+  byte last,
+  byte direction) {
+
+  if (first >= last  ||  last >= CUBE_PALETTE  ||  (direction != '+'  &&  direction != '-')) return;
+
+  unsigned int bytes = (last - first) * sizeof(rgb_t);
+
+  if (direction == '+') {
+    rgb_t wrapped = framePalette[last];
+    memmove(& framePalette[first + 1], & framePalette[first], bytes);
+    framePalette[first] = wrapped;
+  }
+  else {
+    rgb_t wrapped = framePalette[first];
+    memmove(& framePalette[first], & framePalette[first + 1], bytes);
+    framePalette[last] = wrapped;
+  }
+
+  paletteChanged();
+}
+
+void cubePaletteReset(void) {
+  memset(framePalette, 0, sizeof(framePalette));
+  memcpy_P(framePalette, paletteDefaults, min(CUBE_PALETTE, PALETTE_DEFAULTS) * sizeof(rgb_t));
+  paletteChanged();
+}
+
+#endif
+#endif
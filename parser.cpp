@@ -27,8 +27,11 @@ byte parseCommand(
 byte parseRGB(char *message, byte length, byte *position, rgb_t *rgb);
 byte parsePosition(char *message, byte length, byte *position, byte *positionX, byte *positionY, byte *positionZ);
 byte parseOffset(char *message, byte length, byte *position, byte *offset);
+byte parseNumber(char *message, byte length, byte *position, long *number);
 byte parseAxis(char *message, byte length, byte *position, byte *axis);
 byte parseDirection(char *message, byte length, byte *position, byte *direction);
+byte parseFace(char *message, byte length, byte *position, byte *face);
+char *parseRest(char *message, byte length, byte *position);
 
 byte checkForHexadecimal(char *message, byte length, byte *position, byte *digit);
 byte checkForOffset(char *message, byte length, byte *position, byte *digit);
@@ -37,7 +40,7 @@ byte checkForDirection(char *message, byte length, byte *position, byte *digit);
 
 void skipToken(char *message, byte length, byte *position);
 void skipWhitespace(char *message, byte length, byte *position);
-boolean stringCompare(char *source, char *target);
+boolean stringCompare(const char *source, char *target);
 boolean stringDelimiter(char character);
 
 byte parser(
@@ -135,6 +138,67 @@ byte parseCommandShift(
   return(errorCode);
 };
 
+byte parseCommandRotate(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte axis;
+  byte quarters;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseAxis(message, length, position, & axis);
+
+  if (errorCode == 0) {
+    if (parseOffset(message, length, position, & quarters)) quarters = 1;
+
+    cubeRotate(axis, quarters);
+  }
+
+  return(errorCode);
+};
+
+byte parseCommandMirror(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte axis;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseAxis(message, length, position, & axis);
+
+  if (errorCode == 0) cubeMirror(axis);
+
+  return(errorCode);
+};
+
+byte parseCommandTranspose(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte axis1;
+  byte axis2;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseAxis(message, length, position, & axis1);
+  if (errorCode == 0) errorCode = parseAxis(message, length, position, & axis2);
+
+  if (errorCode == 0) cubeTranspose(axis1, axis2);
+
+  return(errorCode);
+};
+
 byte parseCommandSet(
   char       *message,
   byte        length,
@@ -169,14 +233,71 @@ byte parseCommandLine(
   byte positionX2;
   byte positionY2;
   byte positionZ2;
+  byte thickness = 1;
   byte errorCode = 0;
   bytecode->executer = command->executer;
 
   errorCode = parsePosition(message, length, position, & positionX1, & positionY1, & positionZ1);
   errorCode = parsePosition(message, length, position, & positionX2, & positionY2, & positionZ2);
   errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+  if (errorCode == 0) {
+    if (parseOffset(message, length, position, & thickness)) thickness = 1;
+  }
+
+  if (errorCode == 0) cubeLine( positionX1, positionY1, positionZ1, positionX2, positionY2, positionZ2, bytecode->u.lit.colorFrom, thickness);
+
+  return(errorCode);
+};
+
+byte parseCommandTriangle(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte positionX[3];
+  byte positionY[3];
+  byte positionZ[3];
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  for (byte corner = 0;  corner < 3  &&  errorCode == 0;  corner ++) {
+    errorCode = parsePosition(message, length, position, & positionX[corner], & positionY[corner], & positionZ[corner]);
+  }
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+
+  if (errorCode == 0) cubeTriangle(
+    positionX[0], positionY[0], positionZ[0],
+    positionX[1], positionY[1], positionZ[1],
+    positionX[2], positionY[2], positionZ[2], bytecode->u.lit.colorFrom);
+
+  return(errorCode);
+};
+
+byte parseCommandQuad(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte positionX[4];
+  byte positionY[4];
+  byte positionZ[4];
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  for (byte corner = 0;  corner < 4  &&  errorCode == 0;  corner ++) {
+    errorCode = parsePosition(message, length, position, & positionX[corner], & positionY[corner], & positionZ[corner]);
+  }
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
 
-  if (errorCode == 0) cubeLine( positionX1, positionY1, positionZ1, positionX2, positionY2, positionZ2, bytecode->u.lit.colorFrom);
+  if (errorCode == 0) cubeQuad(
+    positionX[0], positionY[0], positionZ[0],
+    positionX[1], positionY[1], positionZ[1],
+    positionX[2], positionY[2], positionZ[2],
+    positionX[3], positionY[3], positionZ[3], bytecode->u.lit.colorFrom);
 
   return(errorCode);
 };
@@ -245,6 +366,37 @@ byte parseCommandSphere(
   return(errorCode);
 };
 
+byte parseCommandEllipsoid(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte positionX1;
+  byte positionY1;
+  byte positionZ1;
+  byte sizeX;
+  byte sizeY;
+  byte sizeZ;
+  byte style = 0;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parsePosition(message, length, position, & positionX1, & positionY1, & positionZ1);
+  if (errorCode == 0) errorCode = parsePosition(message, length, position, & sizeX, & sizeY, & sizeZ);
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+  if (errorCode) return(errorCode);
+
+  // The style and fill are optional
+  if (parseOffset(message, length, position, & style)) style = 0;
+  if (parseRGB(message, length, position, & bytecode->u.lit.colorTo)) bytecode->u.lit.colorTo = BLACK;
+
+  cubeEllipsoid( positionX1, positionY1, positionZ1, sizeX, sizeY, sizeZ, bytecode->u.lit.colorFrom, style, bytecode->u.lit.colorTo);
+
+  return(errorCode);
+};
+
 byte parseCommandNext(
   char       *message,
   byte        length,
@@ -329,6 +481,82 @@ byte parseCommandSetplane(
   return(errorCode);
 };
 
+byte parseCommandFade(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  long period;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parsePosition(message, length, position, & bytecode->u.lit.x1, & bytecode->u.lit.y1, & bytecode->u.lit.z1);
+  if (errorCode == 0) errorCode = parsePosition(message, length, position, & bytecode->u.lit.x2, & bytecode->u.lit.y2, & bytecode->u.lit.z2);
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorTo);
+  if (errorCode == 0) errorCode = parseNumber(message, length, position, & period);
+
+  if (errorCode == 0) {
+    bytecode->u.lit.period = constrain(period, 0, 65535);
+    errorCode = (bytecode->executer)(*bytecode);
+  }
+
+  return(errorCode);
+};
+
+byte parseCommandText(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte face;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseFace(message, length, position, & face);
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+
+  if (errorCode == 0) cubeText(parseRest(message, length, position), face, 0, bytecode->u.lit.colorFrom);
+
+  return(errorCode);
+};
+
+// Without a face, stops scrolling
+
+byte parseCommandScroll(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte face;
+  long period;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  skipWhitespace(message, length, position);
+
+  if (*position >= length  ||  message[*position] == NUL) {
+    cubeScrollStop();
+    return(errorCode);
+  }
+
+  errorCode = parseFace(message, length, position, & face);
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+  if (errorCode == 0) errorCode = parseNumber(message, length, position, & period);
+
+  if (errorCode == 0) {
+    cubeScroll(parseRest(message, length, position), face, bytecode->u.lit.colorFrom, constrain(period, 0, 65535));
+  }
+
+  return(errorCode);
+};
+
 byte parseCommandUser(
   char       *message,
   byte        length,
@@ -361,6 +589,133 @@ byte parseCommandUser(
   return(errorCode);
 };
 
+byte parseCommandPeriod(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  long period;
+  long autoPeriod;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseNumber(message, length, position, & period);
+
+  if (errorCode == 0) {
+    if (parseNumber(message, length, position, & autoPeriod)) autoPeriod = 0;
+
+    cubeSetRefreshPeriod(period, autoPeriod);
+  }
+
+  return(errorCode);
+};
+
+#ifdef CUBE_LAYERS
+byte parseCommandLayer(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte index;
+  byte mode;
+  long opacity;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseOffset(message, length, position, & index);
+
+  if (errorCode == 0) {
+    if (parseOffset(message, length, position, & mode) == 0) {
+      if (parseNumber(message, length, position, & opacity)) opacity = 255;
+
+      cubeLayerBlend(index, mode, constrain(opacity, 0, 255));
+    }
+
+    cubeLayer(index);
+  }
+
+  return(errorCode);
+};
+#endif
+
+#ifdef CUBE_PALETTE
+byte parseCommandPalette(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  long index;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseNumber(message, length, position, & index);
+  if (errorCode == 0) errorCode = parseRGB(message, length, position, & bytecode->u.lit.colorFrom);
+
+  if (errorCode == 0) cubePalette(constrain(index, 0, 255), bytecode->u.lit.colorFrom);
+
+  return(errorCode);
+};
+
+byte parseCommandPaletterotate(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  long first;
+  long last;
+  byte direction;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  errorCode = parseNumber(message, length, position, & first);
+  if (errorCode == 0) errorCode = parseNumber(message, length, position, & last);
+
+  if (errorCode == 0) {
+    if (parseDirection(message, length, position, & direction)) direction = '+';
+
+    cubePaletteRotate(constrain(first, 0, 255), constrain(last, 0, 255), direction);
+  }
+
+  return(errorCode);
+};
+#endif
+
+#ifdef CUBE_SPECTRUM
+// Without an analog input, stops the spectrum
+
+byte parseCommandSpectrum(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  long pin;
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  if (parseNumber(message, length, position, & pin)) {
+    cubeSpectrumStop();
+  }
+  else if (pin >= SPECTRUM_INPUTS) {                // See spectrum.h
+    errorCode = 6;
+  }
+  else {
+    cubeSpectrum(A0 + pin, GREEN, RED);
+  }
+
+  return(errorCode);
+};
+#endif
+
 byte parseCommandHelp(
   char       *message,
   byte        length,
@@ -377,6 +732,9 @@ byte parseCommandHelp(
     serial->println(F("Entire cube:"));
     serial->println(F("  all <colour>;                                        (eg: 'all RED;', or 'all ff0000;')"));
     serial->println(F("  shift <axis> <direction>;                            (eg: 'shift X +;', or 'shift Y -;')"));
+    serial->println(F("  rotate <axis> (<quarter turns>);                     (eg: 'rotate Z;', or 'rotate X 2;')"));
+    serial->println(F("  mirror <axis>;                                       (eg: 'mirror Y;')"));
+    serial->println(F("  transpose <axis> <axis>;                             (eg: 'transpose X Z;')"));
     serial->println(F("Single LED:"));
     serial->println(F("  set <location> <colour>;                             (eg: 'set 112 GREEN;', or 'set 112 00ff00;')"));
     serial->println(F("  next <colour>;                                       (eg: 'next BLUE;', or 'next 0000ff;')"));
@@ -384,11 +742,38 @@ byte parseCommandHelp(
     serial->println(F("  setplane <axis> <offset> <colour>;                   (eg: 'setplane X 2 BLUE;', or 'setplane Y 1 00ff00;')"));
     serial->println(F("  copyplane <axis> <from offset> <to offset>;          (eg: 'copyplane X 2 1;')"));
     serial->println(F("  moveplane <axis> <from offset> <to offset> <colour>; (eg: 'move Z 1 3 BLACK;', or 'move X 3 0 GREEN;')"));
+    serial->println(F("Fades:"));
+    serial->println(F("  fade <location1> <location2> <colour> <colour> <milliseconds>; (eg: 'fade 000 333 RED BLUE 2000;')"));
+    serial->println(F("Text:"));
+    serial->println(F("  text <face:0-4:front/right/back/left/all> <colour> <text>;   (eg: 'text 0 RED HI;')"));
+    serial->println(F("  scroll <face> <colour> <milliseconds> <text>;        (eg: 'scroll 4 BLUE 150 HELLO;', or 'scroll;' to stop)"));
     // Commented out due to taking up an additional 2% program storage space
     // serial->println(F("Graphics and shapes:"));
-    // serial->println(F("  line <location1> <location2> <colour>;                     (eg: 'line 000 333 RED;', or 'line 000 333 ff0000;')"));
+    // serial->println(F("  line <location1> <location2> <colour> (<thickness>);       (eg: 'line 000 333 RED;', or 'line 000 333 ff0000 2;')"));
+    // serial->println(F("  triangle <location1> <location2> <location3> <colour>;      (eg: 'triangle 000 300 030 RED;')"));
+    // serial->println(F("  quad <location1> <location2> <location3> <location4> <colour>; (eg: 'quad 000 300 330 030 BLUE;')"));
     // serial->println(F("  box <location1> <location2> <colour> (<style:0-4:solid/walls only/edges only/walls filled/edges filled>) (<fill>);  (eg: 'box 000 333 GREEN;', or 'box 000 333 00ff00 3 ffffff;')"));
     // serial->println(F("  sphere <centre location> <size> <colour> (<fill>);          (eg: 'sphere 111 3 BLUE;', or 'sphere 111 4 0000ff ffffff;')"));
+    // serial->println(F("  ellipsoid <centre location> <XYZ sizes> <colour> (<style:0/1/3:solid/shell only/shell filled>) (<fill>);  (eg: 'ellipsoid 111 432 RED 1;')"));
+    serial->println(F("Refresh:"));
+    serial->println(F("  period <microseconds> (<busy microseconds>);         (eg: 'period 500;', or 'period 500 1000;')"));
+#ifdef CUBE_STATS
+    serial->println(F("  stats;                                               (refresh interrupt and main loop timing)"));
+    serial->println(F("  resetstats;                                          (restart the timing measurements)"));
+#endif
+#ifdef CUBE_LAYERS
+    serial->println(F("Layers:"));
+    serial->println(F("  layer <layer> (<mode:0-4:replace/add/multiply/max/alpha> (<opacity>)); (eg: 'layer 1;', or 'layer 1 1 128;')"));
+#endif
+#ifdef CUBE_PALETTE
+    serial->println(F("Palette:"));
+    serial->println(F("  palette <index> <colour>;                            (eg: 'palette 3 BLUE;', or 'palette 3 0000ff;')"));
+    serial->println(F("  paletterotate <first> <last> (<direction>);          (eg: 'paletterotate 1 8;', or 'paletterotate 1 8 -;')"));
+#endif
+#ifdef CUBE_SPECTRUM
+    serial->println(F("Spectrum:"));
+    serial->println(F("  spectrum (<analog input>);                           (eg: 'spectrum 4;' for A4, or 'spectrum;' to stop)"));
+#endif
     serial->println(F("Supported colour aliases:"));
     serial->println(F("  BLACK BLUE GREEN ORANGE PINK PURPLE RED WHITE YELLOW"));
 #endif
@@ -398,6 +783,38 @@ byte parseCommandHelp(
   return(errorCode);
 };
 
+#ifdef CUBE_STATS
+byte parseCommandStats(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  cubeStatsPrint();
+
+  return(errorCode);
+};
+
+byte parseCommandResetstats(
+  char       *message,
+  byte        length,
+  byte       *position,
+  command_t  *command,
+  bytecode_t *bytecode) {
+
+  byte errorCode = 0;
+  bytecode->executer = command->executer;
+
+  cubeStatsReset();
+
+  return(errorCode);
+};
+#endif
+
 byte parseRGB(
   char  *message,
   byte   length,
@@ -622,6 +1039,66 @@ byte parseOffset(
   return(errorCode);
 };
 
+byte parseNumber(
+  char  *message,
+  byte   length,
+  byte  *position,
+  long  *number) {
+
+  byte errorCode = 6;
+
+  skipWhitespace(message, length, position);
+
+  *number = 0;
+  byte digits = 0;
+
+  while (*position < length  &&  isDigit(message[*position])) {
+    *number = *number * 10 + message[*position] - '0';
+    (*position) ++;
+    digits ++;
+  }
+
+  // Too long to fit, or not followed by a delimiter, e.g. "500abc"
+
+  if (digits > 0  &&  digits <= NUMBER_DIGITS) {
+    if (*position >= length  ||  stringDelimiter(message[*position])) errorCode = 0;
+  }
+
+  return(errorCode);
+};
+
+// The face, 0 to FACE_WRAP
+
+byte parseFace(
+  char  *message,
+  byte   length,
+  byte  *position,
+  byte  *face) {
+
+  long number;
+  byte errorCode = parseNumber(message, length, position, & number);
+
+  if (errorCode == 0  &&  number > FACE_WRAP) errorCode = 6;
+  *face = number;
+
+  return(errorCode);
+};
+
+// The rest of the message, after any spaces
+
+char *parseRest(
+  char  *message,
+  byte   length,
+  byte  *position) {
+
+  skipWhitespace(message, length, position);
+
+  char *rest = & message[*position];
+  *position = length;
+
+  return(rest);
+};
+
 byte checkForHexadecimal(
   char *message,
   byte  length,
@@ -703,6 +1180,11 @@ byte checkForOffset(
       match = 1;
     }
 
+    if (CUBE_SIZE > 10  &&  message[*position] >= 'a'  &&  message[*position] <= 'f') {
+      *digit = message[*position] - 'a' + 10;  // Single hexadecimal digit positions
+      match = 1;
+    }
+
     if (message[*position] == 'h') {
       *digit = -1;
       match = 1;
@@ -732,7 +1214,7 @@ void skipWhitespace(
 }
 
 boolean stringCompare(
-  char *source,
+  const char *source,
   char *target) {
 
   byte index = 0;
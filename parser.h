@@ -12,8 +12,10 @@ static const byte NUL =   0x00;  // Null character
 static const byte SPACE = 0x20;  // Space bar
 static const byte RBRAC = 0x29;  // Right bracket ')'
 
+static const byte NUMBER_DIGITS = 9;  // Any 9 digit number fits in a long
+
 typedef struct command_s {
-  char  *name;
+  const char *name;
   byte (*parser) (
          char             *message,
          byte              length,
@@ -26,30 +28,78 @@ typedef struct command_s {
 
 byte parseCommandAll(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandShift(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandRotate(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandMirror(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandTranspose(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandSet(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandNext(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandLine(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandTriangle(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandQuad(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandBox(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandSphere(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandEllipsoid(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandSetplane(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandCopyplane(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandMoveplane(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandFade(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandText(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandScroll(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
 byte parseCommandUser(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandPeriod(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+#ifdef CUBE_LAYERS
+byte parseCommandLayer(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+#endif
+#ifdef CUBE_PALETTE
+byte parseCommandPalette(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandPaletterotate(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+#endif
+#ifdef CUBE_SPECTRUM
+byte parseCommandSpectrum(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+#endif
 byte parseCommandHelp(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+#ifdef CUBE_STATS
+byte parseCommandStats(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+byte parseCommandResetstats(char *message, byte length, byte *position, command_t *command, bytecode_t *bytecode);
+#endif
 
 command_t commands[] = {
   "all",       parseCommandAll,       executeNop,
   "shift",     parseCommandShift,     executeNop,
+  "rotate",    parseCommandRotate,    executeNop,
+  "mirror",    parseCommandMirror,    executeNop,
+  "transpose", parseCommandTranspose, executeNop,
   "set",       parseCommandSet,       executeNop,
   "next",      parseCommandNext,      executeNop,
   "line",      parseCommandLine,      executeNop,
+  "triangle",  parseCommandTriangle,  executeNop,
+  "quad",      parseCommandQuad,      executeNop,
   "box",       parseCommandBox,      executeNop,
   "sphere",    parseCommandSphere,    executeNop,
+  "ellipsoid", parseCommandEllipsoid, executeNop,
   "setplane",  parseCommandSetplane,  executeNop,
   "copyplane", parseCommandCopyplane, executeNop,
   "moveplane", parseCommandMoveplane, executeNop,
+  "fade",      parseCommandFade,      executeFade,
+  "text",      parseCommandText,      executeNop,
+  "scroll",    parseCommandScroll,    executeNop,
   "user",      parseCommandUser,      executeNop,
-  "help",      parseCommandHelp,      executeNop
+  "period",    parseCommandPeriod,    executeNop,
+#ifdef CUBE_LAYERS
+  "layer",     parseCommandLayer,     executeNop,
+#endif
+#ifdef CUBE_PALETTE
+  "palette",   parseCommandPalette,   executeNop,
+  "paletterotate", parseCommandPaletterotate, executeNop,
+#endif
+#ifdef CUBE_SPECTRUM
+  "spectrum",  parseCommandSpectrum,  executeNop,
+#endif
+  "help",      parseCommandHelp,      executeNop,
+#ifdef CUBE_STATS
+  "stats",     parseCommandStats,     executeNop,
+  "resetstats",parseCommandResetstats,executeNop
+#endif
 };
 
 byte commandCount = sizeof(commands) / sizeof(command_t);
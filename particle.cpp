@@ -0,0 +1,276 @@
+/*
+ * File:    particle.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Particles, see CUBE_PARTICLES in Cube.h and particle.h.
+ *
+ * The pool is a static array, with the live particles packed at the front:
+ * a particle that dies is replaced by the last live one, so each step only
+ * visits live particles, and costs the same for each of them.  Age is an
+ * 8.8 fixed point fraction of the particle's life, so the colour ramp needs
+ * no division after the particle starts.
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+#ifdef CUBE_PARTICLES
+
+typedef struct {
+  int          x, y, z;                           // 8.8 fixed point voxels
+  int          vx, vy, vz;                        // ... per step
+  unsigned int age;                               // Fraction of life, 8.8
+  unsigned int ageStep;
+  byte         emitter;                           // Colours
+}
+  particle_t;
+
+static particle_t         particles[CUBE_PARTICLES];
+static byte               particleLive = 0;
+static particle_emitter_t particleEmitters[PARTICLE_EMITTERS];
+static unsigned long      particleDue[PARTICLE_EMITTERS];  // Rate, 8.8, room for any rate
+static int                particleGravity[3];
+static byte               particleKeep = 0;
+
+static inline int particleRandom(
+  int spread) {
+
+  return(spread  ?  (int) random(-spread, spread + 1)  :  0);
+}
+
+static inline bool particleInside(
+  particle_t *particle) {
+
+  const unsigned int edge = CUBE_SIZE * PARTICLE_VOXEL;
+
+  return((unsigned int) particle->x < edge  &&
+         (unsigned int) particle->y < edge  &&
+         (unsigned int) particle->z < edge);
+}
+
+// False when the pool is full.  Particles starting outside the cube die.
+
+static bool particleStart(
+  byte index) {
+
+  if (particleLive == CUBE_PARTICLES) return(false);
+
+  particle_emitter_t *emitter = & particleEmitters[index];
+  particle_t         *particle = & particles[particleLive ++];
+
+  particle->x  = emitter->x + (emitter->areaX  ?  (int) random(emitter->areaX)  :  0);
+  particle->y  = emitter->y + (emitter->areaY  ?  (int) random(emitter->areaY)  :  0);
+  particle->z  = emitter->z + (emitter->areaZ  ?  (int) random(emitter->areaZ)  :  0);
+  particle->vx = emitter->vx + particleRandom(emitter->spread);
+  particle->vy = emitter->vy + particleRandom(emitter->spread);
+  particle->vz = emitter->vz + particleRandom(emitter->spread);
+
+  particle->age     = 0;
+  particle->ageStep = 0xffff / max(emitter->life, 1);
+  particle->emitter = index;
+
+  if (! particleInside(particle)) particleLive --;
+  return(true);
+}
+
+// Moves the particle on a step, false when it has died.  It is drawn life
+// times, with its age going from 0 to (life - 1) / life.
+
+static inline bool particleMove(
+  particle_t *particle) {
+
+  particle->age += particle->ageStep;
+  if (particle->age > 0xffff - particle->ageStep) return(false);
+
+  particle->vx += particleGravity[X];
+  particle->vy += particleGravity[Y];
+  particle->vz += particleGravity[Z];
+
+  particle->x += particle->vx;
+  particle->y += particle->vy;
+  particle->z += particle->vz;
+
+  return(particleInside(particle));
+}
+
+static inline byte particleChannel(
+  byte from,
+  byte to,
+  byte step) {
+
+  return((from * (256 - step) + to * step) >> 8);
+}
+
+// Adds the particle's colour to its voxel
+
+static inline void particleDraw(
+  particle_t *particle) {
+
+  particle_emitter_t *emitter = & particleEmitters[particle->emitter];
+  byte step = particle->age >> 8;
+  byte x = particle->x >> 8;
+  byte y = particle->y >> 8;
+  byte z = particle->z >> 8;
+  rgb_t rgb = frameGet(led, x, y, z);
+
+  for (byte color = 0;  color < 3;  color ++) {
+    byte add = particleChannel(emitter->colorFrom.color[color], emitter->colorTo.color[color], step);
+    rgb.color[color] = (rgb.color[color] > 255 - add)  ?  255  :  rgb.color[color] + add;
+  }
+
+  framePut(led, x, y, z, rgb);
+  ledDrawDirty[z] = LED_DIRTY_PLANE;
+}
+
+// What is left of the last step: nothing, or each voxel scaled by keep / 256
+
+static void particleFade(void) {
+  if (particleKeep == 0) {
+    frameFill(led, BLACK);
+  }
+  else {
+    for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+      for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+        for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+          rgb_t rgb = frameGet(led, x, y, z);
+          for (byte color = 0;  color < 3;  color ++) rgb.color[color] = (rgb.color[color] * particleKeep) >> 8;
+          framePut(led, x, y, z, rgb);
+        }
+      }
+    }
+  }
+
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) ledDrawDirty[z] = LED_DIRTY_PLANE;
+}
+
+void Cube::particleEmitter(
+  byte                      index,
+  const particle_emitter_t *emitter) {
+
+  cubeParticleEmitter(index, emitter);
+}
+
+// A copy of emitter is kept, NULL stops the emitter starting particles
+
+void cubeParticleEmitter(
+  byte                      index,
+  const particle_emitter_t *emitter) {
+
+  if (index >= PARTICLE_EMITTERS) return;
+
+  if (emitter) {
+    particleEmitters[index] = *emitter;
+  }
+  else {
+    particleEmitters[index].rate = 0;             // Colours kept for the live ones
+  }
+
+  particleDue[index] = 0;
+}
+
+void Cube::particleBurst(
+  byte index,
+  byte count) {
+
+  cubeParticleBurst(index, count);
+}
+
+// Starts count particles from the emitter now, as many as there is room for
+
+void cubeParticleBurst(
+  byte index,
+  byte count) {
+
+  if (index >= PARTICLE_EMITTERS) return;
+
+  while (count -- > 0  &&  particleStart(index)) ;
+}
+
+void Cube::particleGravity(
+  int x,
+  int y,
+  int z) {
+
+  cubeParticleGravity(x, y, z);
+}
+
+void cubeParticleGravity(
+  int x,
+  int y,
+  int z) {
+
+  particleGravity[X] = x;
+  particleGravity[Y] = y;
+  particleGravity[Z] = z;
+}
+
+void Cube::particleTrail(
+  byte keep) {
+
+  cubeParticleTrail(keep);
+}
+
+void cubeParticleTrail(
+  byte keep) {
+
+  particleKeep = keep;
+}
+
+void Cube::particleStep() {
+  cubeParticleStep();
+}
+
+// Starts new particles, redraws the frame, then moves the particles on for
+// the next step, so each is first drawn where it starts
+
+void cubeParticleStep(void) {
+  for (byte emitter = 0;  emitter < PARTICLE_EMITTERS;  emitter ++) {
+    particleDue[emitter] += particleEmitters[emitter].rate;
+
+    while (particleDue[emitter] >= 256) {
+      particleDue[emitter] -= 256;
+      if (! particleStart(emitter)) particleDue[emitter] &= 0xff;   // Full
+    }
+  }
+
+  particleFade();
+
+  byte index = 0;
+
+  while (index < particleLive) {
+    particleDraw(& particles[index]);
+
+    if (particleMove(& particles[index])) {
+      index ++;
+    }
+    else {
+      particles[index] = particles[-- particleLive];
+    }
+  }
+}
+
+byte Cube::particleCount() {
+  return(cubeParticleCount());
+}
+
+byte cubeParticleCount(void) {
+  return(particleLive);
+}
+
+void Cube::particleClear() {
+  cubeParticleClear();
+}
+
+// All of the particles die, the emitters are kept
+
+void cubeParticleClear(void) {
+  particleLive = 0;
+  for (byte emitter = 0;  emitter < PARTICLE_EMITTERS;  emitter ++) particleDue[emitter] = 0;
+}
+
+#endif
+#endif
@@ -0,0 +1,52 @@
+/*
+ * File:    particle.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Particles, see CUBE_PARTICLES in Cube.h and Cube::particleStep().
+ *
+ * Positions and velocities are 8.8 fixed point voxels (PARTICLE_VOXEL is one
+ * voxel), velocities and gravity per step.  An emitter starts particles at
+ * random in the box from x, y, z to x + areaX, y + areaY, z + areaZ, moving
+ * at vx, vy, vz, plus up to spread either way along each axis, rate / 256
+ * particles per step.  Each lives for life steps (or until it leaves the
+ * cube), changing colour from colorFrom towards colorTo, e.g. rain ...
+ *
+ *   particle_emitter_t rain = {
+ *     0, 0, 3 * PARTICLE_VOXEL,                   // Top plane
+ *     4 * PARTICLE_VOXEL, 4 * PARTICLE_VOXEL, 0,
+ *     0, 0, -PARTICLE_VOXEL / 2,                  // Falling half a voxel a step
+ *     0,
+ *     64, 8,                                      // One every 4 steps
+ *     BLUE, RGB(0x00, 0x00, 0x40)
+ *   };
+ */
+
+#ifndef PARTICLE_h
+#define PARTICLE_h
+
+static const int  PARTICLE_VOXEL    = 256;        // 8.8 fixed point
+static const byte PARTICLE_EMITTERS = 2;
+
+typedef struct {
+  int          x, y, z;                 // Start area corner
+  int          areaX, areaY, areaZ;     // ... and size, 0 for a point
+  int          vx, vy, vz;              // Start velocity
+  int          spread;                  // Random velocity either way
+  unsigned int rate;                    // Particles per step, 8.8
+  byte         life;                    // Steps, 1 to 255
+  rgb_t        colorFrom;
+  rgb_t        colorTo;
+}
+  particle_emitter_t;
+
+extern void cubeParticleEmitter(byte index, const particle_emitter_t *emitter);
+extern void cubeParticleBurst(byte index, byte count);
+extern void cubeParticleGravity(int x, int y, int z);
+extern void cubeParticleTrail(byte keep);
+extern void cubeParticleStep(void);
+extern byte cubeParticleCount(void);
+extern void cubeParticleClear(void);
+
+#endif
@@ -18,7 +18,6 @@
 #include "serial.h"
 
 long    messageTimer = 0;
-long    serialTimer = 0;
 Stream *serial;
 
 extern boolean readMessage(void);
@@ -47,25 +46,43 @@ void Cube::serialBegin(
   }
 }
 
+/* Called by the refresh interrupt, so only buffers the incoming message.
+ * Parsing and executing the message is left to serialPoll().
+ */
 void serialHandler(void) {
-  if (serial) {
+  if (serial  &&  ! messageReady) {
     long timeNow = millis();
 
     if (messageLength > 0) {
       if (timeNow >= messageTimer) messageLength = 0;
     }
 
-    if (timeNow >= serialTimer) {
-      serialTimer = timeNow + SERIAL_HANDLER_PERIOD;
+    messageReady = readMessage();
+  }
+}
 
-      if (readMessage()) {
-//      serial->println(message);
-        receivedSerialCommand = true;
-        bytecode_t bytecode = {};
-        byte errorCode = parser(message, messageLength, & bytecode);
-        messageLength = 0;
-      }
-    }
+/* Called by cubePoll() outside of the refresh interrupt.  Executes at most
+ * one message per call, then hands the message buffer back to serialHandler().
+ */
+void serialPoll(void) {
+  static bool polling = false;  // User functions may call delay(), and so yield()
+
+  if (messageReady  &&  ! polling) {
+    polling = true;
+//  serial->println(message);
+    receivedSerialCommand = true;
+#ifdef CUBE_STATS
+    unsigned long timeStart = micros();
+#endif
+    bytecode_t bytecode = {};
+    byte errorCode = parser(message, messageLength, & bytecode);
+#ifdef CUBE_STATS
+    unsigned long time = micros() - timeStart;
+    if (time > cubeStats.commandMax) cubeStats.commandMax = time;
+#endif
+    messageLength = 0;
+    messageReady = false;
+    polling = false;
   }
 }
 
@@ -75,7 +92,9 @@ boolean Cube::hasReceivedSerialCommand()
 }
 
 boolean readMessage() {
-  while (serial->available()) {
+  byte budget = SERIAL_READ_BUDGET;
+
+  while (budget -- > 0  &&  serial->available()) {
     messageTimer = millis() + MESSAGE_TIMEOUT;
 
     char data = serial->read();
@@ -9,7 +9,7 @@
 #define SERIAL_h
 
 static const unsigned long MESSAGE_TIMEOUT = 5000;  // milliseconds
-static const unsigned long SERIAL_HANDLER_PERIOD = 5;  // milliseconds
+static const byte SERIAL_READ_BUDGET = 8;  // Maximum bytes buffered per refresh interrupt
 
 static const byte NUL =   0x00;  // Null character
 static const byte STX =   0x02;  // Start of TeXt
@@ -27,5 +27,6 @@ static const byte SEMIC = 0x3b;  // Semicolon ';'
 char message[32];
 byte messageLength = 0;
 bool receivedSerialCommand = false;  // Set to true the first time the sketch receives a serial command
+volatile bool messageReady = false;  // Complete message waiting for cubePoll(), stops further buffering
 
 #endif
@@ -0,0 +1,249 @@
+/*
+ * File:    spectrum.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Audio spectrum, see CUBE_SPECTRUM in Cube.h and spectrum.h.
+ *
+ * The ADC runs free, at its slowest clock, and its interrupt only stores
+ * each sample, so it adds a few microseconds to the refresh interrupt at
+ * most.  A conversion that completes during the refresh interrupt is stored
+ * when that returns, so the samples are slightly uneven, which the bars
+ * don't show.  Nothing is sampled or worked out by the refresh interrupt.
+ *
+ * cubeSpectrumPoll(), called by cubePoll(), takes the samples, removes the
+ * DC offset and applies a Hann window, then runs the Goertzel filter for one
+ * band each call: 32 bit state with Q12 coefficients, which can't overflow
+ * for 64 samples of up to 255.  Once all of the bands are done, the bars are
+ * drawn (and shown, when double buffering).
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+#ifdef CUBE_SPECTRUM
+
+const byte spectrumBins[SPECTRUM_BANDS] PROGMEM = {
+  1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 17, 20, 23, 27, 31
+};
+
+// cos() and sin() of 2 * pi * bin / SPECTRUM_SAMPLES, Q12
+
+static const int16_t spectrumCos[SPECTRUM_BANDS] PROGMEM = {
+  4076, 4017, 3920, 3784, 3612, 3406, 3166, 2896, 2276, 1567, 799, -401, -1567, -2598, -3612, -4076
+};
+
+static const int16_t spectrumSin[SPECTRUM_BANDS] PROGMEM = {
+  401, 799, 1189, 1567, 1931, 2276, 2598, 2896, 3406, 3784, 4017, 4076, 3784, 3166, 1931, 401
+};
+
+// First half of a Hann window, 0 to 128
+
+static const byte spectrumWindow[SPECTRUM_SAMPLES / 2] PROGMEM = {
+  0, 1, 2, 4, 6, 9, 13, 17, 21, 26, 31, 37, 42, 48, 55, 61,
+  67, 73, 80, 86, 91, 97, 102, 107, 111, 115, 119, 122, 124, 126, 127, 128
+};
+
+static volatile byte spectrumRing[SPECTRUM_SAMPLES];
+static volatile byte spectrumHead;                // Next to be written
+static volatile byte spectrumCount;               // Up to SPECTRUM_SAMPLES
+
+static int           spectrumBlock[SPECTRUM_SAMPLES];  // Windowed, -255 to 255
+static byte          spectrumLevels[SPECTRUM_BANDS];
+static byte          spectrumBand;                // Next to work out
+static rgb_t         spectrumColor;
+static rgb_t         spectrumPeak;
+static unsigned long spectrumDue;                 // millis() for the next frame
+static bool          spectrumRunning = false;
+
+ISR(ADC_vect) {
+  spectrumRing[spectrumHead] = ADCH;
+  spectrumHead = (spectrumHead + 1) & (SPECTRUM_SAMPLES - 1);
+  if (spectrumCount < SPECTRUM_SAMPLES) spectrumCount ++;
+}
+
+// The latest samples, oldest first, without their DC offset, windowed.  The
+// interrupt may replace the oldest sample meanwhile, rather than holding off
+// the refresh interrupt to stop it.
+
+static void spectrumTake(void) {
+  byte head = spectrumHead;
+  unsigned int sum = 0;
+
+  for (byte index = 0;  index < SPECTRUM_SAMPLES;  index ++) {
+    spectrumBlock[index] = spectrumRing[(head + index) & (SPECTRUM_SAMPLES - 1)];
+    sum += spectrumBlock[index];
+  }
+
+  int mean = sum / SPECTRUM_SAMPLES;
+
+  for (byte index = 0;  index < SPECTRUM_SAMPLES;  index ++) {
+    byte half = (index < SPECTRUM_SAMPLES / 2)  ?  index  :  SPECTRUM_SAMPLES - 1 - index;
+    spectrumBlock[index] = ((spectrumBlock[index] - mean) * pgm_read_byte(spectrumWindow + half)) >> 7;
+  }
+}
+
+// log2(power) in 1/8ths
+
+static byte spectrumLog(
+  unsigned long power) {
+
+  if (power < 8) return(power);
+
+  byte level = 24;
+  while (power >= 16) {
+    power >>= 1;
+    level += 8;
+  }
+
+  return(level + power - 8);
+}
+
+static byte spectrumGoertzel(
+  byte band) {
+
+  long cosine = (int16_t) pgm_read_word(spectrumCos + band);
+  long sine   = (int16_t) pgm_read_word(spectrumSin + band);
+  long s1 = 0, s2 = 0;
+
+  for (byte index = 0;  index < SPECTRUM_SAMPLES;  index ++) {
+    long s0 = spectrumBlock[index] + ((2 * cosine * s1) >> 12) - s2;
+    s2 = s1;
+    s1 = s0;
+  }
+
+  long real      = s1 - ((s2 * cosine) >> 12);
+  long imaginary = (s2 * sine) >> 12;
+
+  return(spectrumLog((unsigned long) (real * real) + (unsigned long) (imaginary * imaginary)));
+}
+
+// Each band's bar covers CUBE_SIZE / 4 x CUBE_SIZE / 4 columns, the lowest
+// band at the front left, along X then back along Y
+
+static void spectrumDraw(void) {
+  const byte width = CUBE_SIZE / 4;
+
+  for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) {
+    byte level  = spectrumLevels[band];
+    byte height = (level <= SPECTRUM_FLOOR)  ?  0  :  (level - SPECTRUM_FLOOR) * CUBE_SIZE / SPECTRUM_RANGE;
+    if (height > CUBE_SIZE) height = CUBE_SIZE;
+
+    byte x1 = (band % 4) * width;
+    byte y1 = (band / 4) * width;
+
+    for (byte z = 0;  z < CUBE_SIZE;  z ++) {
+      rgb_t rgb = (z + 1 < height)  ?  spectrumColor  :  ((z + 1 == height)  ?  spectrumPeak  :  BLACK);
+
+      for (byte y = y1;  y < y1 + width;  y ++) {
+        for (byte x = x1;  x < x1 + width;  x ++) framePut(led, x, y, z, rgb);
+      }
+
+      ledDrawDirty[z] = LED_DIRTY_PLANE;
+    }
+  }
+}
+
+void Cube::spectrum(
+  byte  pin,
+  rgb_t rgb,
+  rgb_t peak) {
+
+  cubeSpectrum(pin, rgb, peak);
+}
+
+// Samples the analog input (e.g. A4, or 4) and draws the bars from then on,
+// in rgb, with the top of each in peak
+
+void cubeSpectrum(
+  byte  pin,
+  rgb_t rgb,
+  rgb_t peak) {
+
+  if (pin >= A0) pin -= A0;
+#ifdef analogPinToChannel
+  byte channel = analogPinToChannel(pin);
+#else
+  byte channel = pin;
+#endif
+
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);   // Stopped
+
+  for (byte band = 0;  band < SPECTRUM_BANDS;  band ++) spectrumLevels[band] = 0;
+
+  spectrumHead    = 0;
+  spectrumCount   = 0;
+  spectrumBand    = SPECTRUM_BANDS;               // Between frames
+  spectrumColor   = rgb;
+  spectrumPeak    = peak;
+  spectrumDue     = millis();
+  spectrumRunning = true;
+
+  // AVcc reference, 8 bit results in ADCH, free running at F_CPU / 128 / 13
+  ADMUX = _BV(REFS0) | _BV(ADLAR) | (channel & 0x07);
+#ifdef MUX5
+  ADCSRB = (channel & 0x08)  ?  _BV(MUX5)  :  0;
+#else
+  ADCSRB = 0;
+#endif
+  ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+}
+
+void Cube::spectrumStop() {
+  cubeSpectrumStop();
+}
+
+// Stops sampling, leaving the ADC for analogRead(), and the bars as they are
+
+void cubeSpectrumStop(void) {
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  spectrumRunning = false;
+}
+
+byte Cube::spectrumLevel(
+  byte band) {
+
+  return(cubeSpectrumLevel(band));
+}
+
+byte cubeSpectrumLevel(
+  byte band) {
+
+  return((band < SPECTRUM_BANDS)  ?  spectrumLevels[band]  :  0);
+}
+
+void cubeSpectrumPoll(void) {
+  if (! spectrumRunning) return;
+
+  if (spectrumBand == SPECTRUM_BANDS) {
+    unsigned long now = millis();
+    if ((long) (now - spectrumDue) < 0  ||  spectrumCount < SPECTRUM_SAMPLES) return;
+
+    // Frames keep to the period, unless poll() is called too late
+    spectrumDue += SPECTRUM_PERIOD;
+    if ((long) (now - spectrumDue) > 0) spectrumDue = now;
+
+    spectrumTake();
+    spectrumBand = 0;
+    return;
+  }
+
+  // The bars are drawn with the last band, once the frame is free (see
+  // cubeFrameFree() in Cube.cpp), the other bands are worked out meanwhile
+  if (spectrumBand == SPECTRUM_BANDS - 1  &&  ! cubeFrameFree()) return;
+
+  byte level = spectrumGoertzel(spectrumBand);
+  byte fallen = (spectrumLevels[spectrumBand] > SPECTRUM_DECAY)  ?  spectrumLevels[spectrumBand] - SPECTRUM_DECAY  :  0;
+  spectrumLevels[spectrumBand] = max(level, fallen);
+
+  if (++ spectrumBand == SPECTRUM_BANDS) {
+    spectrumDraw();
+    cubeFrameDrawn();
+  }
+}
+
+#endif
+#endif
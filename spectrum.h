@@ -0,0 +1,46 @@
+/*
+ * File:    spectrum.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Audio spectrum, see CUBE_SPECTRUM in Cube.h and Cube::spectrum().
+ *
+ * The ADC converts the analog input continuously, SPECTRUM_RATE times a
+ * second, into a ring buffer of the last SPECTRUM_SAMPLES samples.  Every
+ * SPECTRUM_PERIOD milliseconds the latest samples are taken, and the level of
+ * each of SPECTRUM_BANDS frequencies (spectrumBins[band] * SPECTRUM_RATE /
+ * SPECTRUM_SAMPLES Hz, about 150 Hz to 4.6 kHz) is worked out with the
+ * Goertzel algorithm, in fixed point, one band per poll().
+ *
+ * A level is the log2 of the band's power in 1/8ths (each about 0.75 dB),
+ * falling by at most SPECTRUM_DECAY each frame.  Levels from SPECTRUM_FLOOR
+ * up to SPECTRUM_FLOOR + SPECTRUM_RANGE fill the band's bar, from empty to
+ * CUBE_SIZE high.  Silence is below SPECTRUM_FLOOR, a full scale sine wave
+ * about SPECTRUM_FLOOR + SPECTRUM_RANGE.
+ */
+
+#ifndef SPECTRUM_h
+#define SPECTRUM_h
+
+static const byte         SPECTRUM_BANDS   = 16;       // One per 4 x 4 columns
+static const byte         SPECTRUM_SAMPLES = 64;       // Power of 2
+static const unsigned int SPECTRUM_RATE    = F_CPU / 128 / 13;  // Hz
+static const byte         SPECTRUM_PERIOD  = 20;       // Milliseconds per frame
+static const byte         SPECTRUM_FLOOR   = 64;
+static const byte         SPECTRUM_RANGE   = 112;
+static const byte         SPECTRUM_DECAY   = 8;
+static const byte         SPECTRUM_INPUTS  = 6;        // A0 to A5 over serial
+
+// On a Leonardo A6 to A11 are digital pins 4, 6, 8, 9, 10 and 12, and the
+// cube drives 8 to 12 (the 74154 plane select and latch), so serial
+// commands can't sample those.
+
+extern const byte spectrumBins[SPECTRUM_BANDS] PROGMEM;
+
+extern void cubeSpectrum(byte pin, rgb_t rgb, rgb_t peak);
+extern void cubeSpectrumStop(void);
+extern byte cubeSpectrumLevel(byte band);
+extern void cubeSpectrumPoll(void);
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * File:    sprite.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Voxel sprites, see sprite.h for the format.
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+extern byte cursorX, cursorY, cursorZ;           // graphics.h
+
+static inline byte spriteSize(
+  const byte *sprite,
+  byte        axis) {
+
+  return(pgm_read_byte(sprite + SPRITE_SIZE_X + axis));
+}
+
+static inline bool spriteKey(
+  const byte *voxel,
+  rgb_t       key) {
+
+  return(pgm_read_byte(voxel)     == key.color[COLOR_PLANE_RED]    &&
+         pgm_read_byte(voxel + 1) == key.color[COLOR_PLANE_GREEN]  &&
+         pgm_read_byte(voxel + 2) == key.color[COLOR_PLANE_BLUE]);
+}
+
+// The sprite voxels along one axis from first to (but not including) last
+// are in the cube, when the sprite is at offset.  False when none are.
+
+static bool spriteClip(
+  byte  size,
+  int   offset,
+  byte *first,
+  byte *last) {
+
+  int from = (offset < 0)  ?  -offset  :  0;
+  int to   = (offset + size > CUBE_SIZE)  ?  CUBE_SIZE - offset  :  size;
+
+  if (from >= to) return(false);
+
+  *first = from;
+  *last  = to;
+  return(true);
+}
+
+// Draws the voxels that aren't the key colour, in their own colour or all in
+// recolor.  The sprite is clipped to the cube once, before drawing.
+
+static void spriteBlit(
+  const byte  *sprite,
+  int          x,
+  int          y,
+  int          z,
+  rgb_t        key,
+  const rgb_t *recolor) {
+
+  byte sizeX = spriteSize(sprite, X);
+  byte sizeY = spriteSize(sprite, Y);
+  byte firstX, firstY, firstZ, lastX, lastY, lastZ;
+
+  if (! spriteClip(sizeX, x, & firstX, & lastX)  ||
+      ! spriteClip(sizeY, y, & firstY, & lastY)  ||
+      ! spriteClip(spriteSize(sprite, Z), z, & firstZ, & lastZ)) return;
+
+  for (byte sz = firstZ;  sz < lastZ;  sz ++) {
+    bool drawnZ = false;
+
+    for (byte sy = firstY;  sy < lastY;  sy ++) {
+      const byte *voxel = sprite + SPRITE_VOXELS +
+        ((unsigned int) (sz * sizeY + sy) * sizeX + firstX) * sizeof(rgb_t);
+
+      for (byte sx = firstX;  sx < lastX;  sx ++, voxel += sizeof(rgb_t)) {
+        if (spriteKey(voxel, key)) continue;
+
+        rgb_t rgb;
+        if (recolor) {
+          rgb = *recolor;
+        }
+        else {
+          rgb = RGB(pgm_read_byte(voxel), pgm_read_byte(voxel + 1), pgm_read_byte(voxel + 2));
+        }
+
+        cursorX = x + sx;
+        cursorY = y + sy;
+        cursorZ = z + sz;
+        framePut(led, cursorX, cursorY, cursorZ, rgb);
+        drawnZ = true;
+      }
+    }
+
+    if (drawnZ) ledDrawDirty[z + sz] = LED_DIRTY_PLANE;
+  }
+}
+
+void Cube::sprite(
+  const byte *sprite,
+  int   x,
+  int   y,
+  int   z,
+  rgb_t key) {
+
+  cubeSprite(sprite, x, y, z, key);
+}
+
+void cubeSprite(
+  const byte *sprite,
+  int   x,
+  int   y,
+  int   z,
+  rgb_t key) {
+
+  spriteBlit(sprite, x, y, z, key, NULL);
+}
+
+void Cube::spriteColor(
+  const byte *sprite,
+  int   x,
+  int   y,
+  int   z,
+  rgb_t rgb,
+  rgb_t key) {
+
+  cubeSpriteColor(sprite, x, y, z, rgb, key);
+}
+
+void cubeSpriteColor(
+  const byte *sprite,
+  int   x,
+  int   y,
+  int   z,
+  rgb_t rgb,
+  rgb_t key) {
+
+  spriteBlit(sprite, x, y, z, key, & rgb);
+}
+
+boolean Cube::spriteCollision(
+  const byte *sprite1,
+  int   x1,
+  int   y1,
+  int   z1,
+  const byte *sprite2,
+  int   x2,
+  int   y2,
+  int   z2,
+  rgb_t key) {
+
+  return(cubeSpriteCollision(sprite1, x1, y1, z1, sprite2, x2, y2, z2, key));
+}
+
+// Whether any voxels of the two sprites, other than the key colour, are in
+// the same place (inside the cube or not).  Only the overlap of the two
+// sprites' boxes is checked.
+
+boolean cubeSpriteCollision(
+  const byte *sprite1,
+  int   x1,
+  int   y1,
+  int   z1,
+  const byte *sprite2,
+  int   x2,
+  int   y2,
+  int   z2,
+  rgb_t key) {
+
+  int offset1[3] = { x1, y1, z1 };
+  int offset2[3] = { x2, y2, z2 };
+  int first[3];
+  int last[3];
+
+  for (byte axis = X;  axis <= Z;  axis ++) {
+    first[axis] = max(offset1[axis], offset2[axis]);
+    last[axis]  = min(offset1[axis] + spriteSize(sprite1, axis), offset2[axis] + spriteSize(sprite2, axis));
+    if (first[axis] >= last[axis]) return(false);
+  }
+
+  byte sizeX1 = spriteSize(sprite1, X), sizeY1 = spriteSize(sprite1, Y);
+  byte sizeX2 = spriteSize(sprite2, X), sizeY2 = spriteSize(sprite2, Y);
+
+  for (int z = first[Z];  z < last[Z];  z ++) {
+    for (int y = first[Y];  y < last[Y];  y ++) {
+      for (int x = first[X];  x < last[X];  x ++) {
+        const byte *voxel1 = sprite1 + SPRITE_VOXELS + sizeof(rgb_t) *
+          (((unsigned int) (z - z1) * sizeY1 + (y - y1)) * sizeX1 + (x - x1));
+        const byte *voxel2 = sprite2 + SPRITE_VOXELS + sizeof(rgb_t) *
+          (((unsigned int) (z - z2) * sizeY2 + (y - y2)) * sizeX2 + (x - x2));
+
+        if (! spriteKey(voxel1, key)  &&  ! spriteKey(voxel2, key)) return(true);
+      }
+    }
+  }
+
+  return(false);
+}
+#endif
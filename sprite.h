@@ -0,0 +1,34 @@
+/*
+ * File:    sprite.h
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Voxel sprites, stored in program memory (see Cube::sprite()).
+ *
+ * A sprite is a byte array: its size along X, Y and Z, then the red, green
+ * and blue of each voxel, X fastest, then Y, then Z.  Voxels in the key
+ * colour (BLACK unless given) are transparent, e.g. a 2x1x2 sprite ...
+ *
+ *   const byte ship[] PROGMEM = {
+ *     2, 1, 2,
+ *     0x00, 0x00, 0xff,   0x00, 0x00, 0xff,   // Z 0: X 0, X 1
+ *     0x00, 0x00, 0x00,   0xff, 0xff, 0x00    // Z 1: X 0 is transparent
+ *   };
+ */
+
+#ifndef SPRITE_h
+#define SPRITE_h
+
+static const byte SPRITE_SIZE_X = 0;              // Header byte offsets
+static const byte SPRITE_SIZE_Y = 1;
+static const byte SPRITE_SIZE_Z = 2;
+static const byte SPRITE_VOXELS = 3;
+
+extern void cubeSprite(const byte *sprite, int x, int y, int z, rgb_t key = BLACK);
+extern void cubeSpriteColor(const byte *sprite, int x, int y, int z, rgb_t rgb, rgb_t key = BLACK);
+extern boolean cubeSpriteCollision(
+  const byte *sprite1, int x1, int y1, int z1,
+  const byte *sprite2, int x2, int y2, int z2, rgb_t key = BLACK);
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * File:    transform.cpp
+ * Version: 0.0
+ * Author:  Freetronics (support@freetronics.com.au)
+ * License: GPLv3
+ *
+ * Whole cube rotations, mirrors and transposes of the drawing buffer (the
+ * back buffer when double buffering).
+ *
+ * Each of these moves every source axis onto a destination axis, possibly
+ * reversed.  That is turned into a table per source axis, giving each
+ * coordinate's destination coordinate and its part of the destination voxel
+ * number, so moving a voxel takes three lookups.  The voxels are moved in
+ * place in one pass, by following each cycle of the permutation, with a
+ * bitmask of the voxels already moved.
+ */
+
+#ifndef CUBE_cpp
+#define CUBE_cpp
+
+#include "Cube.h"
+
+static const unsigned int TRANSFORM_VOXELS = CUBE_SIZE * PLANE_VOXELS;
+
+typedef struct transform_s {
+  byte         axis[3];                          // Destination of each axis
+  byte         coordinate[3][CUBE_SIZE];         // Destination coordinate
+  unsigned int voxel[3][CUBE_SIZE];              // Part of destination voxel
+}
+  transform_t;
+
+static const unsigned int VOXEL_STRIDE[3] = { PLANE_VOXELS, CUBE_SIZE, 1 };
+
+// Source axis moves onto destination axis, reversed when flip[axis] is set
+
+static void transformTables(
+  transform_t *transform,
+  const byte  *axis,
+  const bool  *flip) {
+
+  for (byte source = X;  source <= Z;  source ++) {
+    byte destination = axis[source];
+    transform->axis[source] = destination;
+
+    for (byte value = 0;  value < CUBE_SIZE;  value ++) {
+      byte coordinate = flip[source]  ?  CUBE_SIZE - 1 - value  :  value;
+      transform->coordinate[source][value] = coordinate;
+      transform->voxel[source][value] = coordinate * VOXEL_STRIDE[destination];
+    }
+  }
+}
+
+static void transformApply(
+  const transform_t *transform) {
+
+  byte moved[(TRANSFORM_VOXELS + 7) / 8];
+  memset(moved, 0, sizeof(moved));
+
+  unsigned int start = 0;
+
+  for (byte x = 0;  x < CUBE_SIZE;  x ++) {
+    for (byte y = 0;  y < CUBE_SIZE;  y ++) {
+      for (byte z = 0;  z < CUBE_SIZE;  z ++, start ++) {
+        if (moved[start >> 3] & (1 << (start & 7))) continue;
+
+        // Carry the voxel around its cycle, until back at the start
+
+        byte  from[3] = { x, y, z };
+        voxel_t carried = frameGetVoxel(led, x, y, z);
+        unsigned int voxel;
+
+        do {
+          byte to[3];
+          voxel = 0;
+
+          for (byte axis = X;  axis <= Z;  axis ++) {
+            to[transform->axis[axis]] = transform->coordinate[axis][from[axis]];
+            voxel += transform->voxel[axis][from[axis]];
+          }
+
+          voxel_t displaced = frameGetVoxel(led, to[X], to[Y], to[Z]);
+          framePutVoxel(led, to[X], to[Y], to[Z], carried);
+          moved[voxel >> 3] |= 1 << (voxel & 7);
+
+          carried = displaced;
+          memcpy(from, to, sizeof(from));
+        }
+        while (voxel != start);
+      }
+    }
+  }
+
+  volatile byte *dirty = ledDrawDirty;
+  for (byte z = 0;  z < CUBE_SIZE;  z ++) dirty[z] = LED_DIRTY_PLANE;
+}
+
+void Cube::rotate(
+  byte axis,
+  byte quarters) {
+
+  cubeRotate(axis, quarters);
+}
+
+// Quarter turns anticlockwise, looking from the positive end of the axis
+// towards the origin, e.g. about Z, X moves onto Y and Y onto -X
+
+void cubeRotate(
+  byte axis,
+  byte quarters) {
+
+  if (axis > Z  ||  (quarters &= 3) == 0) return;
+
+  byte to[3]   = { X, Y, Z };
+  bool flip[3] = { false, false, false };
+  byte first   = (axis + 1) % 3;
+  byte second  = (axis + 2) % 3;
+
+  while (quarters --) {
+    for (byte source = X;  source <= Z;  source ++) {
+      if (to[source] == first) {
+        to[source] = second;
+      }
+      else if (to[source] == second) {
+        to[source] = first;
+        flip[source] = ! flip[source];
+      }
+    }
+  }
+
+  transform_t transform;
+  transformTables(& transform, to, flip);
+  transformApply(& transform);
+}
+
+void Cube::mirror(
+  byte axis) {
+
+  cubeMirror(axis);
+}
+
+void cubeMirror(
+  byte axis) {
+
+  if (axis > Z) return;
+
+  byte to[3]   = { X, Y, Z };
+  bool flip[3] = { false, false, false };
+  flip[axis] = true;
+
+  transform_t transform;
+  transformTables(& transform, to, flip);
+  transformApply(& transform);
+}
+
+void Cube::transpose(
+  byte axis1,
+  byte axis2) {
+
+  cubeTranspose(axis1, axis2);
+}
+
+void cubeTranspose(
+  byte axis1,
+  byte axis2) {
+
+  if (axis1 > Z  ||  axis2 > Z  ||  axis1 == axis2) return;
+
+  byte to[3]   = { X, Y, Z };
+  bool flip[3] = { false, false, false };
+  to[axis1] = axis2;
+  to[axis2] = axis1;
+
+  transform_t transform;
+  transformTables(& transform, to, flip);
+  transformApply(& transform);
+}
+#endif